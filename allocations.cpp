@@ -0,0 +1,47 @@
+#include <new>
+#include <cstdlib>
+
+#include "allocations.hpp"
+
+#ifdef AMAZING_COUNT_ALLOCATIONS
+
+static thread_local long allocations = 0;
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+long thread_allocation_count() {
+    return allocations;
+}
+
+#else
+
+long thread_allocation_count() {
+    return 0;
+}
+
+#endif
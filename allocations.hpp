@@ -0,0 +1,9 @@
+#ifndef _allocations_hpp_
+#define _allocations_hpp_
+
+// Heap allocation counting, compiled in with AMAZING_COUNT_ALLOCATIONS: the
+// global operator new is replaced to count the allocations of each thread.
+// Without the option the count stays at zero.
+long thread_allocation_count();
+
+#endif
@@ -1,30 +1,112 @@
-#include <iostream>
-#include <SFML/Graphics.hpp>
-#include <GL/glew.h>
-
-#include "misc.hpp"
-#include "timer.hpp"
-#include "matrix.hpp"
-#include "geometry.hpp"
-#include "graph.hpp"
-#include "program.hpp"
-#include "amazing.hpp"
-
-int main() {
-    srand((unsigned int)time(0));
-    sf::ContextSettings settings;
-    settings.antialiasingLevel = 2;
-    settings.depthBits = 16;
-    sf::RenderWindow window(sf::VideoMode(800, 600), "Amazing!", sf::Style::Default, settings);
-    //sf::RenderWindow window(sf::VideoMode::getFullscreenModes()[0], "Amazing!", sf::Style::Fullscreen, settings);
-    //window.setFramerateLimit(60);
-    window.setVerticalSyncEnabled(true);
-    window.setMouseCursorVisible(false);
-    sf::Font font;
-    if (!font.loadFromFile("anonymous.ttf")) {
-        return -1;
-    }
-    glewInit();
-    glViewport(0, 0, window.getSize().x, window.getSize().y);
-    menu(window, font);
-}
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <SFML/Graphics.hpp>
+#include <GL/glew.h>
+
+#include "misc.hpp"
+#include "timer.hpp"
+#include "matrix.hpp"
+#include "geometry.hpp"
+#include "graph.hpp"
+#include "program.hpp"
+#include "amazing.hpp"
+#include "assets.hpp"
+#include "resources.hpp"
+#include "lockstep.hpp"
+#include "snapshot.hpp"
+
+// Multiplayer, all the players share one maze:
+//   amazing --host [--players N] [--size S] [--port P]
+//   amazing --join ADDRESS [--port P]
+//   amazing --local N [--size S] [--ticks T]   bots over loopback, no window
+// or straight into a game saved with F5:
+//   amazing --resume FILE
+int main(int argc, char* argv[]) {
+    srand((unsigned int)time(0));
+    bool host = false;
+    std::string address;
+    unsigned short port = lockstep_session::default_port;
+    int players = 2;
+    int size = 31;
+    int local = 0;
+    long ticks = 3000;
+    std::string resume;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool value = i + 1 < argc;
+        if (arg == "--host") host = true;
+        else if (arg == "--join" && value) address = argv[++i];
+        else if (arg == "--port" && value) port = (unsigned short) atoi(argv[++i]);
+        else if (arg == "--players" && value) players = atoi(argv[++i]);
+        else if (arg == "--size" && value) size = std::max(5, atoi(argv[++i]) | 1);
+        else if (arg == "--local" && value) local = atoi(argv[++i]);
+        else if (arg == "--ticks" && value) ticks = atol(argv[++i]);
+        else if (arg == "--resume" && value) resume = argv[++i];
+        else {
+            std::cout << "unknown option " << arg << std::endl;
+            return -1;
+        }
+    }
+    if (local > 0) {
+        return run_local_lockstep(local, size, ticks) ? 0 : -1;
+    }
+    std::unique_ptr<lockstep_session> session;
+    std::vector<char> snapshot;
+    int snapshot_width = 0;
+    int snapshot_height = 0;
+    try {
+        if (host) {
+            std::cout << "waiting for " << players - 1 << " players on port " << port << std::endl;
+            session = lockstep_session::host(port, (unsigned) rand(), size, players);
+        } else if (!address.empty()) {
+            session = lockstep_session::join(address, port);
+        } else if (!resume.empty()) {
+            snapshot = read_snapshot_file(resume);
+            // a bad file fails here, on a scratch game, rather than in play
+            get_snapshot_size(snapshot, snapshot_width, snapshot_height);
+            maze_model scratch_model(snapshot_width, snapshot_height);
+            auto scratch = make_game_data(scratch_model, 0, 0, 0);
+            restore_snapshot(snapshot, *scratch);
+        }
+    } catch (std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return -1;
+    }
+
+    // start reading and decoding the assets, the menu renders meanwhile
+    asset_loader& assets = asset_loader::get();
+    asset<sf::Font> font = assets.font("anonymous.ttf");
+    for (auto name : { "smiley.png", "evil.png" }) {
+        assets.image(name);
+    }
+    for (auto name : { "flatShading.vert", "flatShading.frag", "grid.vert", "grid.frag", "monochrome.vert", "monochrome.frag",
+                       "texture.vert", "texture.frag", "sprite.vert" }) {
+        assets.text(name);
+    }
+    sf::ContextSettings settings;
+    settings.antialiasingLevel = 2;
+    settings.depthBits = 16;
+    sf::RenderWindow window(sf::VideoMode(800, 600), "Amazing!", sf::Style::Default, settings);
+    //sf::RenderWindow window(sf::VideoMode::getFullscreenModes()[0], "Amazing!", sf::Style::Fullscreen, settings);
+    //window.setFramerateLimit(60);
+    window.setVerticalSyncEnabled(true);
+    window.setMouseCursorVisible(false);
+    glewInit();
+    glViewport(0, 0, window.getSize().x, window.getSize().y);
+    if (session) {
+        const lockstep_setup& setup = session->get_setup();
+        maze_model model(setup.size, setup.size);
+        model.create(setup.seed);
+        play(model, window, color(0.0f, 1.0f, 0.0f), font, session.get());
+        resource_cache::get().clear();
+        return 0;
+    }
+    if (!snapshot.empty()) {
+        maze_model model(snapshot_width, snapshot_height);
+        play(model, window, color(0.0f, 1.0f, 0.0f), font, nullptr, &snapshot);
+        resource_cache::get().clear();
+        return 0;
+    }
+    menu(window, font);
+}
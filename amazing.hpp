@@ -9,6 +9,9 @@
 
 #include "geometry.hpp"
 #include "context.hpp"
+#include "graph.hpp"
+#include "random.hpp"
+#include "assets.hpp"
 
 struct cell {
     int x;
@@ -28,11 +31,15 @@ struct pos {
 class maze_model {
 public:
     maze_model(int width_, int height_);
+    // the same seed carves the same maze
+    void create(unsigned seed_);
     void create();
+    unsigned get_seed();
     int get_width();
     int get_height();
     inline cell& get_cell(int x, int y) { return cells[x + y*width]; }
     inline cell& get_cell(pos p) { return get_cell(p.x, p.y); }
+    inline void set_wall(int x, int y, bool wall) { get_cell(x, y).wall = wall; }
     inline bool is_wall(int x, int y) { return (x < 0) || (x >= width) || (y < 0) || (y >= height) || get_cell(x, y).wall; }
     inline bool is_wall(float x, float y) { return is_wall((int)floor(x), (int)floor(y)); }
     inline std::vector<cell>& get_cells() { return cells; }
@@ -40,7 +47,7 @@ public:
     inline bool contains(cell& c, std::set<cell, cell::comp>& visited) { return visited.find(c) != visited.end(); }
     pos find_empty_cell(int line, int col);
 private:
-    void visit(cell& c, std::set<cell, cell::comp>& visited, int& count);
+    void visit(cell& c, std::set<cell, cell::comp>& visited, int& count, rng& random);
     int width;
     int height;
     std::vector<cell> cells;
@@ -50,37 +57,85 @@ private:
 class maze_geometry_builder_2d {
 public:
     maze_geometry_builder_2d(maze_model& model_);
+    // the interleaved vertices, computed on worker threads without GL
+    std::vector<float> generate();
+    // generate() uploaded in one buffer
     std::shared_ptr<geometry<float>> build();
+    vertex_layout layout();
 private:
     maze_model& model;
 };
 
+// 2D maze geometry: the walls of maze_geometry_builder_2d, except for the
+// cells whose wall can change, which get a fixed slot of four vertices after
+// them, so that a wall can be added or knocked out by re-uploading only that
+// cell. Open slots are degenerate quads. Changing another cell rebuilds the
+// buffer.
+class mutable_maze_geometry_2d {
+public:
+    mutable_maze_geometry_2d(maze_model& model_, const std::vector<pos>& changeable_);
+    std::shared_ptr<geometry<float>> get_geometry() { return geom; }
+    // to be called after changing the cell in the model
+    void update_cell(int x, int y);
+    // to be called after changing many cells in the model, uploads them all
+    void rebuild();
+private:
+    std::vector<float> generate();
+    void write_cell(const cell& c, float* v);
+    maze_model& model;
+    std::vector<pos> changeable;
+    // the index in changeable of each cell, -1 for the others
+    std::vector<int> slots;
+    GLsizei first_slot;
+    std::shared_ptr<geometry<float>> geom;
+};
+
+// The 2D maze as a texture of its wall grid and a single quad over the whole
+// maze, drawn with grid_program. The cost of drawing it does not depend on
+// the size of the maze.
+class maze_grid_2d {
+public:
+    maze_grid_2d(maze_model& model_);
+    std::shared_ptr<geometry<float>> get_geometry() { return quad; }
+    std::shared_ptr<grid_texture> get_grid() { return grid; }
+    // to be called after changing the cell in the model
+    void update_cell(int x, int y);
+    // to be called after changing many cells in the model, uploads them all
+    void rebuild();
+private:
+    std::vector<GLubyte> generate();
+    maze_model& model;
+    std::shared_ptr<geometry<float>> quad;
+    std::shared_ptr<grid_texture> grid;
+};
+
 class maze_geometry_builder_3d {
 public:
     maze_geometry_builder_3d(maze_model& model_);
+    // the interleaved vertices, computed on worker threads without GL
+    std::vector<float> generate();
+    // generate() uploaded in one buffer
     std::shared_ptr<geometry<float>> build();
+    vertex_layout layout();
 private:
     maze_model& model;
 };
 
-class hero_builder_2d {
+// unit quad shared by all the actors, see actor_instance_layout()
+class actor_builder_2d {
 public:
-    hero_builder_2d();
+    actor_builder_2d();
     std::shared_ptr<geometry<float>> build();
 };
 
+vertex_layout actor_instance_layout();
+
 class multi_hero_builder_2d {
 public:
     multi_hero_builder_2d();
     std::shared_ptr<geometry<float>> build();
 };
 
-class bad_guy_builder_2d {
-public:
-    bad_guy_builder_2d();
-    std::shared_ptr<geometry<float>> build();
-};
-
 enum class menu_choice {
     undefined,
     select_maze,
@@ -89,10 +144,37 @@ enum class menu_choice {
     exit
 };
 
-void menu(sf::RenderWindow& window, sf::Font& font);
+// the spinning 3D maze of the menu
+struct maze_scene {
+    std::shared_ptr<camera> cam;
+    std::shared_ptr<group> root;
+    std::shared_ptr<group> spin;
+    std::shared_ptr<node> scene;
+    std::shared_ptr<flat_shading_program> flat_shading_pr;
+};
+
+std::shared_ptr<maze_scene> make_maze_scene(maze_model& model, int width, int height);
+void resize_maze_scene(maze_scene& s, maze_model& model, int width, int height);
+// flushes ctx.queue when it is set
+void render_maze_scene(maze_scene& s, rendering_context& ctx, const color& col);
+
+// the sizes of the mazes offered by the menu
+extern const int maze_sizes[];
+extern const int maze_size_count;
+
+void menu(sf::RenderWindow& window, asset<sf::Font> font);
+
+class lockstep_session;
+
+// With a session, the game is the one shared with the other players. With a
+// snapshot, the game resumes from it, model must have its size.
+void play(maze_model& model, sf::RenderWindow& window, color color, asset<sf::Font> font, lockstep_session* session = nullptr,
+          const std::vector<char>* snapshot = nullptr);
 
-void play(maze_model& model, sf::RenderWindow& window, color color, sf::Font& font);
+// the text of F3 drawn over the frame, the GL state is released first
+sf::Text make_overlay_text(asset<sf::Font> font);
+void draw_overlay(sf::RenderWindow& window, sf::Text& text, const std::string& s);
 
-void ending(sf::RenderWindow& window, sf::Font& font, std::string text, std::shared_ptr<texture> tex);
+void ending(sf::RenderWindow& window, asset<sf::Font> font, std::string text, std::shared_ptr<texture> tex);
 
 #endif
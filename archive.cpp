@@ -0,0 +1,147 @@
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "archive.hpp"
+
+// Layout written by pack.cpp, all integers little endian:
+//   "AMZPAK01", uint32 count,
+//   count x {uint32 name length, name, uint64 offset, uint64 size},
+//   then the file contents, each aligned on 16 bytes.
+
+#ifdef AMAZING_EMBEDDED_ARCHIVE
+extern const unsigned char amazing_embedded_archive[];
+extern const size_t amazing_embedded_archive_size;
+#endif
+
+static const char magic[8] = {'A', 'M', 'Z', 'P', 'A', 'K', '0', '1'};
+
+static uint64_t read_le(const char* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | (unsigned char) p[i];
+    }
+    return v;
+}
+
+archive& archive::get() {
+    static archive a;
+    return a;
+}
+
+archive::archive() : base(nullptr), size(0), mapped(false) {
+#ifdef _WIN32
+    file = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+#endif
+    if (map_file("assets.pak")) {
+        return;
+    }
+#ifdef AMAZING_EMBEDDED_ARCHIVE
+    if (!read_index((const char*) amazing_embedded_archive, amazing_embedded_archive_size)) {
+        std::cout << "Corrupted embedded assets" << std::endl;
+        entries.clear();
+        base = nullptr;
+    }
+#endif
+}
+
+archive::~archive() {
+    unmap();
+}
+
+void archive::unmap() {
+    if (mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+        CloseHandle(mapping);
+        CloseHandle(file);
+#else
+        munmap((void*) base, size);
+#endif
+    }
+    mapped = false;
+    base = nullptr;
+    size = 0;
+    entries.clear();
+}
+
+bool archive::map_file(const std::string& filename) {
+#ifdef _WIN32
+    file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    const char* data = (const char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    size_t length = (size_t) file_size.QuadPart;
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+    }
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    size_t length = st.st_size;
+    void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    const char* data = p == MAP_FAILED ? nullptr : (const char*) p;
+#endif
+    if (data == nullptr) return false;
+    mapped = true;
+    if (!read_index(data, length)) {
+        std::cout << "Corrupted " << filename << std::endl;
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+bool archive::read_index(const char* data, size_t length) {
+    base = data;
+    size = length;
+    if (length < 12 || memcmp(data, magic, 8) != 0) return false;
+    size_t count = read_le(data + 8, 4);
+    size_t pos = 12;
+    for (size_t i = 0; i < count; i++) {
+        if (pos + 4 > length) return false;
+        size_t name_length = read_le(data + pos, 4);
+        pos += 4;
+        if (name_length > length - pos || 16 > length - pos - name_length) return false;
+        std::string name(data + pos, name_length);
+        pos += name_length;
+        uint64_t offset = read_le(data + pos, 8);
+        uint64_t entry_size = read_le(data + pos + 8, 8);
+        pos += 16;
+        // apart, so that a hostile offset cannot wrap around
+        if (offset > length || entry_size > length - offset) return false;
+        asset_view view = {data + offset, (size_t) entry_size};
+        entries[name] = view;
+    }
+    return true;
+}
+
+bool archive::find(const std::string& name, asset_view& view) const {
+    auto it = entries.find(name);
+    if (it == entries.end()) return false;
+    view = it->second;
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef _archive_hpp_
+#define _archive_hpp_
+
+#include <string>
+#include <map>
+#include <cstddef>
+
+// a read only slice of the archive, valid for the lifetime of the process
+struct asset_view {
+    const char* data;
+    size_t size;
+};
+
+// All the assets packed in one file by amazing_pack. The file is mapped in
+// memory once and lookups hand out views into the mapping, nothing is
+// copied. When the assets are embedded in the executable, an assets.pak in
+// the working directory still takes precedence so they can be changed
+// without relinking.
+class archive {
+public:
+    static archive& get();
+    ~archive();
+    bool find(const std::string& name, asset_view& view) const;
+    bool is_open() const { return base != nullptr; }
+private:
+    archive();
+    archive(const archive&);
+    bool map_file(const std::string& filename);
+    void unmap();
+    bool read_index(const char* data, size_t size);
+
+    const char* base;
+    size_t size;
+    bool mapped;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+    std::map<std::string, asset_view> entries;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "arena.hpp"
+
+frame_arena::frame_arena(size_t capacity) : capacity(0), used(0), overflow_size(0) {
+    reserve(capacity);
+}
+
+void* frame_arena::allocate(size_t size, size_t alignment) {
+    size_t start = (used + alignment - 1) & ~(alignment - 1);
+    if (start + size <= capacity) {
+        used = start + size;
+        return block.get() + start;
+    }
+    overflow.push_back(std::unique_ptr<char[]>(new char[size + alignment]));
+    overflow_size += size + alignment;
+    char* p = overflow.back().get();
+    return p + ((alignment - (size_t) p % alignment) % alignment);
+}
+
+void frame_arena::reserve(size_t new_capacity) {
+    if (new_capacity > capacity) {
+        block.reset(new char[new_capacity]);
+        capacity = new_capacity;
+    }
+    used = 0;
+}
+
+void frame_arena::reset() {
+    if (!overflow.empty()) {
+        overflow.clear();
+        reserve(capacity + overflow_size);
+        overflow_size = 0;
+    }
+    used = 0;
+}
@@ -0,0 +1,34 @@
+#ifndef _arena_hpp_
+#define _arena_hpp_
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Bump allocator for the transient buffers of a frame. Allocating is moving
+// a pointer, nothing is freed individually and reset() releases everything
+// at the top of the next frame. A frame needing more than the capacity gets
+// extra blocks from the heap, and the next reset() grows the arena to the
+// size that frame needed, so that steady frames do not touch the heap.
+class frame_arena {
+public:
+    frame_arena(size_t capacity = 64 * 1024);
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    template <class T>
+    T* allocate_array(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+    // not while allocations of the current frame are in use
+    void reserve(size_t capacity);
+    void reset();
+    size_t get_capacity() const { return capacity; }
+private:
+    frame_arena(const frame_arena&);
+    std::unique_ptr<char[]> block;
+    size_t capacity;
+    size_t used;
+    std::vector<std::unique_ptr<char[]>> overflow;
+    size_t overflow_size;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "assets.hpp"
+
+// assets are taken from the packed archive, loose files are only a fallback
+// for running straight from the source tree
+
+static std::shared_ptr<sf::Image> load_image(const std::string& filename) {
+    auto image = std::make_shared<sf::Image>();
+    asset_view view;
+    bool loaded = archive::get().find(filename, view)
+        ? image->loadFromMemory(view.data, view.size)
+        : image->loadFromFile(filename);
+    if (!loaded) {
+        std::cout << "Failed to load " << filename << std::endl;
+    }
+    image->flipVertically();
+    return image;
+}
+
+static std::shared_ptr<std::string> load_text(const std::string& filename) {
+    asset_view view;
+    if (archive::get().find(filename, view)) {
+        return std::make_shared<std::string>(view.data, view.size);
+    }
+    std::ifstream f(filename);
+    std::stringstream buffer;
+    buffer << f.rdbuf();
+    return std::make_shared<std::string>(buffer.str());
+}
+
+static std::shared_ptr<sf::Font> load_font(const std::string& filename) {
+    auto font = std::make_shared<sf::Font>();
+    // the font reads its glyphs lazily from the view, which stays mapped
+    asset_view view;
+    bool loaded = archive::get().find(filename, view)
+        ? font->loadFromMemory(view.data, view.size)
+        : font->loadFromFile(filename);
+    if (!loaded) {
+        std::cout << "Failed to load " << filename << std::endl;
+    }
+    return font;
+}
+
+asset_loader& asset_loader::get() {
+    static asset_loader loader;
+    return loader;
+}
+
+asset_loader::asset_loader() : packed(archive::get()), stopping(false), worker(&asset_loader::run, this) {}
+
+asset_loader::~asset_loader() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_one();
+    worker.join();
+}
+
+asset<sf::Image> asset_loader::image(const std::string& filename) {
+    return enqueue(images, filename, load_image);
+}
+
+asset<std::string> asset_loader::text(const std::string& filename) {
+    return enqueue(texts, filename, load_text);
+}
+
+asset<sf::Font> asset_loader::font(const std::string& filename) {
+    return enqueue(fonts, filename, load_font);
+}
+
+void asset_loader::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = tasks.front();
+            tasks.pop_front();
+        }
+        task();
+    }
+}
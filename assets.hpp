@@ -0,0 +1,66 @@
+#ifndef _assets_hpp_
+#define _assets_hpp_
+
+#include <string>
+#include <map>
+#include <deque>
+#include <memory>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <SFML/Graphics.hpp>
+
+#include "archive.hpp"
+
+// handle on an asset being loaded, get() blocks until it is available
+template <class T>
+using asset = std::shared_future<std::shared_ptr<T>>;
+
+// Reads and decodes asset files on a background thread, so that the loads
+// can start while the menu is already rendering. Only the GL uploads are
+// left to the context thread. Requesting the same file twice returns the
+// same handle.
+class asset_loader {
+public:
+    static asset_loader& get();
+    ~asset_loader();
+    // decoded RGBA pixels, flipped for OpenGL
+    asset<sf::Image> image(const std::string& filename);
+    asset<std::string> text(const std::string& filename);
+    asset<sf::Font> font(const std::string& filename);
+private:
+    asset_loader();
+    asset_loader(const asset_loader&);
+    void run();
+
+    template <class T, class F>
+    asset<T> enqueue(std::map<std::string, asset<T>>& loaded, const std::string& filename, F load) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = loaded.find(filename);
+        if (it != loaded.end()) {
+            return it->second;
+        }
+        auto task = std::make_shared<std::packaged_task<std::shared_ptr<T>()>>(std::bind(load, filename));
+        asset<T> handle = task->get_future().share();
+        loaded[filename] = handle;
+        tasks.push_back([task]() { (*task)(); });
+        condition.notify_one();
+        return handle;
+    }
+
+    // the mapping the loaded assets point into, reached first so that the
+    // archive is constructed before the loader and destroyed after it
+    archive& packed;
+    std::map<std::string, asset<sf::Image>> images;
+    std::map<std::string, asset<std::string>> texts;
+    std::map<std::string, asset<sf::Font>> fonts;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+    std::thread worker;
+};
+
+#endif
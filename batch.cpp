@@ -0,0 +1,137 @@
+// Batch simulation: plays many independent games without a window, the hero
+// driven by the wandering bot, across a pool of threads, and reports the
+// throughput and the outcomes.
+//   amazing_batch [--games N] [--size S] [--bad-guys N] [--ticks N]
+//                 [--threads N] [--seed N]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "amazing.hpp"
+#include "game.hpp"
+#include "timer.hpp"
+#include "misc.hpp"
+
+struct batch_options {
+    int games;
+    int size;
+    int bad_guys;
+    long ticks;
+    int threads;
+    unsigned seed;
+};
+
+// the outcomes counted by one worker
+struct batch_stats {
+    long won;
+    long lost;
+    long timeout;
+    long ticks;
+};
+
+// A game is built, played to its end and freed by the worker that claims it,
+// so that its maze and actors stay in that core's cache. Game i is seeded
+// with seed + i, whatever the thread running it.
+static void run_games(const batch_options& options, std::atomic<int>& next, batch_stats& result) {
+    batch_stats stats{ 0, 0, 0, 0 };
+    int i;
+    while ((i = next.fetch_add(1)) < options.games) {
+        unsigned seed = options.seed + i;
+        maze_model model(options.size, options.size);
+        model.create(seed);
+        auto game = make_game_data(model, seed, options.bad_guys);
+        game_outcome outcome = game_outcome::running;
+        while (outcome == game_outcome::running && game->tick < options.ticks) {
+            game->arena.reset();
+            actor_data& hero = *game->heroes_data[0];
+            hero.next_direction = bot_direction(*game, hero, game->random);
+            update_game(*game);
+            outcome = get_outcome(*game);
+        }
+        switch (outcome) {
+        case game_outcome::won: stats.won++; break;
+        case game_outcome::lost: stats.lost++; break;
+        default: stats.timeout++; break;
+        }
+        stats.ticks += game->tick;
+    }
+    result = stats;
+}
+
+int main(int argc, char* argv[]) {
+    batch_options options;
+    options.games = 1000;
+    options.size = 31;
+    options.bad_guys = -1;
+    options.ticks = 10000;
+    options.threads = std::max(1, (int) std::thread::hardware_concurrency());
+    options.seed = 1;
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (i + 1 == argc) {
+            std::cout << "missing value for " << arg << std::endl;
+            return -1;
+        }
+        const char* text = argv[i + 1];
+        long seed = 0;
+        bool parsed;
+        if (arg == "--games") parsed = parse_int(text, options.games);
+        else if (arg == "--size") parsed = parse_int(text, options.size);
+        else if (arg == "--bad-guys") parsed = parse_int(text, options.bad_guys);
+        else if (arg == "--ticks") parsed = parse_long(text, options.ticks);
+        else if (arg == "--threads") parsed = parse_int(text, options.threads);
+        else if (arg == "--seed") {
+            parsed = parse_long(text, seed);
+            options.seed = (unsigned) seed;
+        }
+        else {
+            std::cout << "unknown option " << arg << std::endl;
+            return -1;
+        }
+        if (!parsed) {
+            std::cout << "bad value for " << arg << ": " << text << std::endl;
+            return -1;
+        }
+    }
+    options.games = std::max(1, options.games);
+    options.size = std::max(5, options.size | 1);
+    options.ticks = std::max(1L, options.ticks);
+    options.threads = std::max(1, options.threads);
+
+    std::vector<batch_stats> stats(options.threads, batch_stats{ 0, 0, 0, 0 });
+    std::atomic<int> next(0);
+    timer batch_timer;
+    std::vector<std::thread> threads;
+    for (int t = 1; t < options.threads; t++) {
+        threads.push_back(std::thread(run_games, std::cref(options), std::ref(next), std::ref(stats[t])));
+    }
+    run_games(options, next, stats[0]);
+    for (auto& t : threads) {
+        t.join();
+    }
+    double seconds = batch_timer.elapsed();
+
+    batch_stats total{ 0, 0, 0, 0 };
+    for (auto& s : stats) {
+        total.won += s.won;
+        total.lost += s.lost;
+        total.timeout += s.timeout;
+        total.ticks += s.ticks;
+    }
+    std::cout << std::fixed << std::setprecision(1)
+              << "games=" << options.games << " size=" << options.size
+              << " threads=" << options.threads << " seed=" << options.seed
+              << " seconds=" << std::setprecision(3) << seconds
+              << std::setprecision(1)
+              << " games_per_s=" << options.games / seconds
+              << " ticks_per_s=" << total.ticks / seconds
+              << " won=" << total.won << " lost=" << total.lost << " timeout=" << total.timeout
+              << " mean_ticks=" << (double) total.ticks / options.games
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Benchmark of the maze model, the maze vertex generation and the bad guys'
+// path finding, without a window. Every size of the menu and a few larger
+// ones are timed with fixed seeds, one JSON object per line:
+//   {"bench": "create", "size": 11, "iterations": 120, "mean_us": ..., ...}
+//   amazing_bench [--size S]... [--min-time SECONDS]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <thread>
+#include <cstdlib>
+
+#include "amazing.hpp"
+#include "game.hpp"
+#include "timer.hpp"
+#include "misc.hpp"
+
+// keeps the optimizer from dropping the work measured
+static volatile long sink;
+
+// Runs f for at least min_time and 3 times, f making calls calls of what is
+// measured, and prints the time of a call.
+template <class F>
+static void measure(const std::string& name, int size, double min_time, int calls, F f) {
+    std::vector<double> times;
+    timer total;
+    while (times.size() < 3 || total.elapsed() < min_time) {
+        timer t;
+        f();
+        times.push_back(t.elapsed() / calls);
+    }
+    std::sort(times.begin(), times.end());
+    double sum = 0.0;
+    for (double t : times) sum += t;
+    size_t n = times.size();
+    std::cout << std::fixed << std::setprecision(3)
+              << "{\"bench\": \"" << name << "\", \"size\": " << size
+              << ", \"seed\": " << size
+              << ", \"iterations\": " << n * calls
+              << ", \"mean_us\": " << sum / n * 1e6
+              << ", \"min_us\": " << times[0] * 1e6
+              << ", \"p50_us\": " << times[n / 2] * 1e6
+              << ", \"max_us\": " << times[n - 1] * 1e6
+              << "}" << std::endl;
+}
+
+static void bench_size(int size, double min_time) {
+    // the seed of a size is the size, the same maze from run to run
+    unsigned seed = size;
+    measure("create", size, min_time, 1, [&]() {
+        maze_model model(size, size);
+        model.create(seed);
+        sink += model.get_cells().size();
+    });
+
+    maze_model model(size, size);
+    model.create(seed);
+
+    // where the bad guys spawn
+    int spawns = std::max(1, size / 10);
+    measure("find_empty_cell", size, min_time, 1000 * spawns, [&]() {
+        for (int k = 0; k < 1000; k++) {
+            for (int i = 0; i < spawns; i++) {
+                sink += model.find_empty_cell(size - 2 - i * 10, size - 2 - i * 10).x;
+            }
+        }
+    });
+    measure("generate_2d", size, min_time, 1, [&]() {
+        maze_geometry_builder_2d builder(model);
+        sink += builder.generate().size();
+    });
+    measure("generate_3d", size, min_time, 1, [&]() {
+        maze_geometry_builder_3d builder(model);
+        sink += builder.generate().size();
+    });
+
+    // Cells at odd coordinates are always open. The hero is put close to
+    // the first bad guy so that the bad guys search for it.
+    auto game = make_game_data(model, seed);
+    int near = std::max(1, (size - 12) | 1);
+    game->heroes_data[0]->pos_x = near;
+    game->heroes_data[0]->pos_y = near;
+    int center = size / 2 | 1;
+    int far = std::max(1, center - 10);
+    measure("get_best_direction", size, min_time, 1, [&]() {
+        game->arena.reset();
+        sink += (long) get_best_direction(*game, pos{ center, center }, pos{ far, far }, 50);
+    });
+    measure("update_bad_guys_directions", size, min_time, 1, [&]() {
+        game->arena.reset();
+        update_bad_guys_directions(*game);
+        sink += (long) game->bad_guys_data.size();
+    });
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    double min_time = 0.2;
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (i + 1 == argc) {
+            std::cout << "missing value for " << arg << std::endl;
+            return -1;
+        }
+        const char* text = argv[i + 1];
+        int size = 0;
+        bool parsed;
+        if (arg == "--size") {
+            parsed = parse_int(text, size);
+            sizes.push_back(std::max(5, size | 1));
+        }
+        else if (arg == "--min-time") parsed = parse_double(text, min_time);
+        else {
+            std::cout << "unknown option " << arg << std::endl;
+            return -1;
+        }
+        if (!parsed) {
+            std::cout << "bad value for " << arg << ": " << text << std::endl;
+            return -1;
+        }
+    }
+    if (sizes.empty()) {
+        sizes.assign(maze_sizes, maze_sizes + maze_size_count);
+        for (int size : { 251, 301, 401 }) {
+            sizes.push_back(size);
+        }
+    }
+    std::cout << "{\"bench\": \"info\", \"threads\": " << std::thread::hardware_concurrency()
+              << ", \"min_time_s\": " << min_time << "}" << std::endl;
+    for (int size : sizes) {
+        bench_size(size, min_time);
+    }
+    return 0;
+}
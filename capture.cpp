@@ -0,0 +1,147 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <cstring>
+#include <SFML/Graphics.hpp>
+
+#include "capture.hpp"
+#include "state.hpp"
+
+static const size_t max_queued_frames = 16;
+
+frame_recorder::frame_recorder(const std::string& prefix, format fmt, int ring_size) :
+    prefix(prefix), fmt(fmt), ring(ring_size), next(0), frame_count(0), dropped(0),
+    stopping(false), writer(&frame_recorder::run, this)
+{
+    for (auto& s : ring) {
+        glGenBuffers(1, &s.pbo);
+        s.size = 0;
+        s.pending = false;
+    }
+}
+
+frame_recorder::~frame_recorder() {
+    // the oldest frames first, the ring is in submission order from next
+    for (size_t i = 0; i < ring.size(); i++) {
+        slot& s = ring[(next + i) % ring.size()];
+        if (s.pending) retrieve(s);
+    }
+    gl_state::get().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+    for (auto& s : ring) {
+        glDeleteBuffers(1, &s.pbo);
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_one();
+    writer.join();
+    std::cout << "Recorded " << frame_count - dropped << " frames to " << prefix << "-*";
+    if (dropped > 0) std::cout << ", dropped " << dropped;
+    std::cout << std::endl;
+}
+
+void frame_recorder::capture(int width, int height) {
+    gl_state& state = gl_state::get();
+    slot& s = ring[next];
+    if (s.pending) {
+        retrieve(s);
+    }
+    state.bind_buffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    GLsizeiptr size = (GLsizeiptr) width * height * 4;
+    if (size != s.size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        s.size = size;
+    }
+    // the pack state is shared with every other read, it is put back after
+    GLint alignment;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // with a pack buffer bound this only queues the transfer
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, alignment);
+    // left bound, SFML would read into the buffer
+    state.bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+    s.width = width;
+    s.height = height;
+    s.index = frame_count++;
+    s.pending = true;
+    next = (next + 1) % ring.size();
+}
+
+void frame_recorder::retrieve(slot& s) {
+    s.pending = false;
+    frame f;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (frames.size() >= max_queued_frames) {
+            dropped++;
+            return;
+        }
+        if (!spare.empty()) {
+            f.pixels.swap(spare.back());
+            spare.pop_back();
+        }
+    }
+    gl_state::get().bind_buffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    const GLubyte* data = (const GLubyte*) glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (data == nullptr) {
+        dropped++;
+        return;
+    }
+    f.index = s.index;
+    f.width = s.width;
+    f.height = s.height;
+    f.pixels.resize(s.size);
+    memcpy(&f.pixels[0], data, s.size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        frames.push_back(std::move(f));
+    }
+    condition.notify_one();
+}
+
+void frame_recorder::run() {
+    while (true) {
+        frame f;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !frames.empty(); });
+            if (frames.empty()) return;
+            f = std::move(frames.front());
+            frames.pop_front();
+        }
+        write(f);
+        std::unique_lock<std::mutex> lock(mutex);
+        spare.push_back(std::move(f.pixels));
+    }
+}
+
+void frame_recorder::write(const frame& f) {
+    std::ostringstream name;
+    name << prefix << "-" << std::setw(6) << std::setfill('0') << f.index;
+    if (fmt == RAW) {
+        name << "-" << f.width << "x" << f.height << ".rgba";
+        std::ofstream out(name.str(), std::ios::binary);
+        out.write((const char*) &f.pixels[0], f.pixels.size());
+    } else {
+        name << ".png";
+        sf::Image image;
+        image.create(f.width, f.height, &f.pixels[0]);
+        image.flipVertically();
+        image.saveToFile(name.str());
+    }
+}
+
+void toggle_recording(std::unique_ptr<frame_recorder>& recorder, frame_recorder::format fmt) {
+    if (recorder) {
+        recorder.reset();
+        return;
+    }
+    std::ostringstream prefix;
+    prefix << "capture-" << time(0);
+    recorder.reset(new frame_recorder(prefix.str(), fmt));
+}
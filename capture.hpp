@@ -0,0 +1,65 @@
+#ifndef _capture_hpp_
+#define _capture_hpp_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <GL/glew.h>
+
+// Records the rendered frames without stalling the pipeline. Each frame is
+// read back into one of a ring of pixel buffer objects, mapped only when the
+// ring comes back to it, and handed to a writer thread that stores it as
+// <prefix>-<frame>.png or as raw bottom-up RGBA in
+// <prefix>-<frame>-<width>x<height>.rgba.
+// Frames are dropped rather than queued without end if the writer cannot
+// keep up.
+class frame_recorder {
+public:
+    enum format { PNG, RAW };
+    frame_recorder(const std::string& prefix, format fmt, int ring_size = 3);
+    // writes the frames still in flight
+    ~frame_recorder();
+    // to be called once the frame is rendered, before displaying it
+    void capture(int width, int height);
+private:
+    struct slot {
+        GLuint pbo;
+        GLsizeiptr size;
+        int width;
+        int height;
+        long index;
+        bool pending;
+    };
+    struct frame {
+        long index;
+        int width;
+        int height;
+        std::vector<GLubyte> pixels;
+    };
+    frame_recorder(const frame_recorder&);
+    void retrieve(slot& s);
+    void run();
+    void write(const frame& f);
+
+    std::string prefix;
+    format fmt;
+    std::vector<slot> ring;
+    size_t next;
+    long frame_count;
+    long dropped;
+    std::deque<frame> frames;
+    std::vector<std::vector<GLubyte>> spare;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+    std::thread writer;
+};
+
+// starts recording with a new prefix, or stops the current recording
+void toggle_recording(std::unique_ptr<frame_recorder>& recorder, frame_recorder::format fmt);
+
+#endif
@@ -1,9 +1,9 @@
-#version 330 core
-
-in vec4 vColor;
-out vec4 fColor;
-
-void main(void)
-{
-    fColor = vColor;
-}
+#version 330 core
+
+in vec4 vColor;
+out vec4 fColor;
+
+void main(void)
+{
+    fColor = vColor;
+}
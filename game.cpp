@@ -0,0 +1,404 @@
+#include <map>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+
+#include "game.hpp"
+#include "state.hpp"
+#include "gpu_timer.hpp"
+#include "resources.hpp"
+
+typedef int distance;
+
+struct movement {
+    int dx;
+    int dy;
+};
+
+std::map<direction, movement> move = {
+    { direction::up, { 0, 1 } },
+    { direction::down, { 0, -1 } },
+    { direction::right, { 1, 0 } },
+    { direction::left, { -1, 0 } }
+};
+
+// sprite indices in the actors atlas
+enum actor_sprite {
+    HERO_SPRITE, BAD_GUY_SPRITE
+};
+
+static std::vector<std::string> actor_sprite_files = { "smiley.png", "evil.png" };
+
+std::shared_ptr<camera> create_game_camera(int width, int height) {
+    clipping_volume cv;
+    int div = 100;
+    cv.right = (float)width / div;
+    cv.left = (float)-width / div;
+    cv.bottom = (float)-height / div;
+    cv.top = (float)height / div;
+    cv.nearp = 1.0f;
+    cv.farp = -1.0f;
+    return std::make_shared<parallel_camera>(parallel_camera(cv));
+}
+
+bool is_int(float f, float eps) {
+    return fabs(f - round(f)) < eps;
+}
+
+void update_position(actor_data& ad, maze_model& model) {
+    switch (ad.dir) {
+    case direction::left:
+        if (!model.is_wall(ad.pos_x - 1, ad.pos_y)) ad.pos_fx -= ad.inc;
+        break;
+    case direction::right:
+        if (!model.is_wall(ad.pos_x + 1, ad.pos_y)) { ad.pos_fx += ad.inc;  }
+        break;
+    case direction::up:
+        if (!model.is_wall(ad.pos_x, ad.pos_y + 1)) ad.pos_fy += ad.inc;
+        break;
+    case direction::down:
+        if (!model.is_wall(ad.pos_x, ad.pos_y - 1)) ad.pos_fy -= ad.inc;
+        break;
+    default:
+        break;
+    };
+    if (is_int(ad.pos_fx, ad.inc / 10.0f) && (is_int(ad.pos_fy, ad.inc / 10.0f))) {
+        ad.pos_x = (int)round(ad.pos_fx);
+        ad.pos_y = (int)round(ad.pos_fy);
+        ad.pos_fx = (float)ad.pos_x;
+        ad.pos_fy = (float)ad.pos_y;
+        ad.dir = ad.next_direction;
+    }
+}
+
+std::shared_ptr<actor_batch> make_actor_batch(const std::string& name) {
+    auto batch = std::make_shared<actor_batch>();
+    batch->quad = resource_cache::get().acquire<geometry<float>>("geometry:" + name, []() {
+        actor_builder_2d builder;
+        return builder.build();
+    });
+    batch->root = std::make_shared<group>();
+    batch->root->add(std::make_shared<geometry_node<float>>(batch->quad));
+    batch->layout = actor_instance_layout();
+    return batch;
+}
+
+void add_instance(actor_batch& batch, const actor_data& ad, float sprite) {
+    batch.instances.push_back(ad.pos_fx);
+    batch.instances.push_back(ad.pos_fy);
+    batch.instances.push_back(sprite);
+}
+
+void upload_instances(actor_batch& batch) {
+    batch.quad->set_instances(batch.instances.data(), batch.instances.size() * sizeof(float),
+                              batch.layout, batch.instances.size() / batch.layout.stride);
+    batch.instances.clear();
+}
+
+void update_actor_batches(game_data& game, actor_batch& batch) {
+    for (auto& hero_data : game.heroes_data) {
+        add_instance(batch, *hero_data, HERO_SPRITE);
+    }
+    for (auto& bad_guy_data : game.bad_guys_data) {
+        add_instance(batch, *bad_guy_data, BAD_GUY_SPRITE);
+    }
+    upload_instances(batch);
+}
+
+static pos spawn_position(maze_model& model, int i, rng& random) {
+    if (i < model.get_height() / 10) {
+        return model.find_empty_cell(model.get_height() - 2 - i * 10, model.get_width() - 2 - i * 10);
+    }
+    // more bad guys than usual go anywhere open
+    while (true) {
+        int x = random.below(model.get_width());
+        int y = random.below(model.get_height());
+        if (!model.is_wall(x, y)) return pos{ x, y };
+    }
+}
+
+std::shared_ptr<game_data> make_game_data(maze_model& model, unsigned seed, int bad_guys, int heroes) {
+    auto game = std::make_shared<game_data>(model, seed);
+    // the heroes all start at the entrance
+    for (int i = 0; i < heroes; i++) {
+        std::shared_ptr<actor_data> hero_data = std::make_shared<actor_data>(actor_data());
+        hero_data->pos_x = 0;
+        hero_data->pos_y = 1;
+        hero_data->pos_fx = 0;
+        hero_data->pos_fy = 1;
+        hero_data->dir = direction::none;
+        hero_data->next_direction = direction::none;
+        hero_data->inc = hero_inc;
+        hero_data->nature = actor_nature::good;
+        game->heroes_data.push_back(hero_data);
+    }
+    if (bad_guys < 0) {
+        bad_guys = model.get_height() / 10;
+    }
+    for (int i = 0; i < bad_guys; i++) {
+        std::shared_ptr<actor_data> bad_guy_data = std::make_shared<actor_data>(actor_data());
+        pos p = spawn_position(model, i, game->random);
+        bad_guy_data->pos_x = p.x;
+        bad_guy_data->pos_y = p.y;
+        bad_guy_data->pos_fx = (float) p.x;
+        bad_guy_data->pos_fy = (float) p.y;
+        bad_guy_data->dir = direction::none;
+        bad_guy_data->next_direction = direction::none;
+        bad_guy_data->inc = bad_guy_inc;
+        bad_guy_data->nature = actor_nature::evil;
+        game->bad_guys_data.push_back(bad_guy_data);
+    }
+    // room for the path finding, so that no frame grows the arena
+    game->arena.reserve(model.get_width() * model.get_height() * sizeof(int) + 4096);
+    return game;
+}
+
+// either way the walls can change during the game
+std::shared_ptr<node> make_maze_group(game_data& game, game_scene& scene, maze_renderer renderer) {
+    auto maze_group = std::make_shared<group>(group());
+    std::shared_ptr<geometry<float>> geom;
+    if (renderer == maze_renderer::grid) {
+        scene.maze_grid = std::make_shared<maze_grid_2d>(game.model);
+        geom = scene.maze_grid->get_geometry();
+    } else {
+        // no mode knocks walls out during a game yet, the walls a snapshot
+        // changes rebuild the buffer
+        scene.maze = std::make_shared<mutable_maze_geometry_2d>(game.model, std::vector<pos>());
+        geom = scene.maze->get_geometry();
+    }
+    auto maze_node = std::make_shared<geometry_node<float>>(geometry_node<float>(geom));
+    maze_group->add(maze_node);
+    return std::make_shared<compiled_group>(maze_group);
+}
+
+// best distances found so far, in the frame arena and shared by the path
+// findings of a frame
+class mat {
+public:
+    mat(int w, int h, frame_arena& arena) : w(w), h(h) {
+        ia = arena.allocate_array<int>(w*h);
+    }
+    void clear() {
+        for (int i = 0; i < w*h; ++i) {
+            ia[i] = std::numeric_limits<int>::max();
+        }
+    }
+    int& elem(int x, int y) { return ia[w*y + x]; }
+private:
+    int w;
+    int h;
+    int* ia;
+};
+
+distance get_shortest_distance(pos src, pos dest, direction dir, game_data& g, distance d, mat& m, int& best) {
+    d++;
+    if (d > best) return std::numeric_limits<int>::max();
+    auto& movement = move.at(dir);
+    src.x += movement.dx;
+    src.y += movement.dy;
+    if (g.model.is_like_wall(src.x, src.y)) return std::numeric_limits<int>::max();
+    int& best_m = m.elem(src.x, src.y);
+    if (d > best_m) return std::numeric_limits<int>::max();
+    best_m = d;
+    if (dest == src) {
+        best = d;
+        return d;
+    } else {
+        for (auto dir : { direction::up, direction::down, direction::left, direction::right }) {
+            get_shortest_distance(src, dest, dir, g, d, m, best);
+        }
+        return best;
+    }
+}
+
+direction get_best_direction(pos& src, pos& dest, game_data& game, mat& m, int best) {
+    distance shortest = std::numeric_limits<int>::max();
+    direction best_dir = direction::none;
+    if (src == dest) return direction::none;
+    m.clear();
+    m.elem(src.x, src.y) = 0;
+    int best_found = best;
+    for (auto dir : { direction::up, direction::down, direction::left, direction::right }) {
+        int d = get_shortest_distance(src, dest, dir, game, 0, m, best_found);
+        if (d < shortest) {
+            shortest = d;
+            best_dir = dir;
+        }
+    }
+    if (best == best_found) {
+        best_dir = direction::none;
+    }
+    return best_dir;
+}
+
+direction get_best_direction(game_data& game, pos src, pos dest, int best) {
+    mat m{ game.model.get_width(), game.model.get_height(), game.arena };
+    return get_best_direction(src, dest, game, m, best);
+}
+
+void find_chasing_directions(game_data& game, direction* ways, bool* chasing) {
+    mat m{ game.model.get_width(), game.model.get_height(), game.arena };
+    for (size_t i = 0; i < game.bad_guys_data.size(); i++) {
+        actor_data& bad_guy_data = *game.bad_guys_data[i];
+        int best = 50;
+        pos src{ int(bad_guy_data.pos_fx + 0.5), int(bad_guy_data.pos_fy + 0.5) };
+        // chase the closest hero
+        pos dest{ game.heroes_data[0]->pos_x, game.heroes_data[0]->pos_y };
+        for (auto& hero_data : game.heroes_data) {
+            pos p{ hero_data->pos_x, hero_data->pos_y };
+            if (abs(src.x - p.x) + abs(src.y - p.y) < abs(src.x - dest.x) + abs(src.y - dest.y)) dest = p;
+        }
+        chasing[i] = abs(src.x - dest.x) + abs(src.y - dest.y) < best;
+        ways[i] = chasing[i] ? get_best_direction(src, dest, game, m, best) : direction::none;
+    }
+}
+
+void wander(game_data& game) {
+    static const direction dirs[] = { direction::up, direction::down, direction::left, direction::right };
+    for (auto& bad_guy_data : game.bad_guys_data) {
+        if (bad_guy_data->next_direction == direction::none) {
+            bad_guy_data->next_direction = dirs[game.random.below(4)];
+        }
+    }
+}
+
+// the search does not draw from the generator, so the bad guys wander in
+// the same order as when each one wandered right after its search
+void update_bad_guys_directions(game_data& game) {
+    size_t count = game.bad_guys_data.size();
+    direction* ways = game.arena.allocate_array<direction>(count);
+    bool* chasing = game.arena.allocate_array<bool>(count);
+    find_chasing_directions(game, ways, chasing);
+    for (size_t i = 0; i < count; i++) {
+        if (chasing[i]) game.bad_guys_data[i]->next_direction = ways[i];
+    }
+    wander(game);
+}
+
+void move_actors(game_data& game) {
+    for (auto& hero_data : game.heroes_data) {
+        update_position(*hero_data, game.model);
+    }
+    for (auto& bad_guy_data : game.bad_guys_data) {
+        update_position(*bad_guy_data, game.model);
+    }
+}
+
+void update_game(game_data& game) {
+    move_actors(game);
+    update_bad_guys_directions(game);
+    game.tick++;
+}
+
+direction bot_direction(game_data& game, const actor_data& hero, rng& random) {
+    direction open[4];
+    int count = 0;
+    if (!game.model.is_wall(hero.pos_x, hero.pos_y + 1)) open[count++] = direction::up;
+    if (!game.model.is_wall(hero.pos_x, hero.pos_y - 1)) open[count++] = direction::down;
+    if (!game.model.is_wall(hero.pos_x + 1, hero.pos_y)) open[count++] = direction::right;
+    if (!game.model.is_wall(hero.pos_x - 1, hero.pos_y)) open[count++] = direction::left;
+    return count > 0 ? open[random.below(count)] : direction::none;
+}
+
+game_outcome get_outcome(game_data& game) {
+    for (auto& hero_data : game.heroes_data) {
+        actor_data& hero = *hero_data;
+        if (hero.pos_x == game.model.get_width() - 1 && hero.pos_y == game.model.get_height() - 2) {
+            return game_outcome::won;
+        }
+        for (auto& bad_guy_data : game.bad_guys_data) {
+            if (hero.pos_x == bad_guy_data->pos_x && hero.pos_y == bad_guy_data->pos_y) {
+                return game_outcome::lost;
+            }
+        }
+    }
+    return game_outcome::running;
+}
+
+// FNV-1a
+static void hash(uint32_t& h, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*) data;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+}
+
+static void hash_actor(uint32_t& h, const actor_data& ad) {
+    hash(h, &ad.pos_x, sizeof(ad.pos_x));
+    hash(h, &ad.pos_y, sizeof(ad.pos_y));
+    hash(h, &ad.pos_fx, sizeof(ad.pos_fx));
+    hash(h, &ad.pos_fy, sizeof(ad.pos_fy));
+    hash(h, &ad.dir, sizeof(ad.dir));
+    hash(h, &ad.next_direction, sizeof(ad.next_direction));
+}
+
+uint32_t game_checksum(game_data& game) {
+    uint32_t h = 2166136261u;
+    hash(h, &game.tick, sizeof(game.tick));
+    uint64_t state = game.random.get_state();
+    hash(h, &state, sizeof(state));
+    for (auto& hero_data : game.heroes_data) {
+        hash_actor(h, *hero_data);
+    }
+    for (auto& bad_guy_data : game.bad_guys_data) {
+        hash_actor(h, *bad_guy_data);
+    }
+    return h;
+}
+
+void set_wall(game_data& game, game_scene& scene, int x, int y, bool wall) {
+    game.model.set_wall(x, y, wall);
+    if (scene.maze) scene.maze->update_cell(x, y);
+    if (scene.maze_grid) scene.maze_grid->update_cell(x, y);
+}
+
+void walls_changed(game_scene& scene) {
+    if (scene.maze) scene.maze->rebuild();
+    if (scene.maze_grid) scene.maze_grid->rebuild();
+}
+
+std::shared_ptr<game_scene> make_game_scene(game_data& game, const color& col, int width, int height, maze_renderer renderer) {
+    resource_cache& resources = resource_cache::get();
+    auto scene = std::make_shared<game_scene>();
+    scene->hero = 0;
+    scene->cam = create_game_camera(width, height);
+    scene->cam->move_up(1.5f);
+    scene->cam->move_right(0.5f);
+    scene->maze_group = make_maze_group(game, *scene, renderer);
+    if (renderer == maze_renderer::grid) {
+        auto grid_pr = resources.acquire<grid_program>("program:grid", grid_program::create);
+        grid_pr->set_color(col);
+        grid_pr->set_grid(scene->maze_grid->get_grid());
+        scene->maze_pr = grid_pr;
+    } else {
+        auto monochrome_pr = resources.acquire<monochrome_program>("program:monochrome", monochrome_program::create);
+        monochrome_pr->set_color(col);
+        scene->maze_pr = monochrome_pr;
+    }
+    scene->sprite_pr = resources.acquire<sprite_program>("program:sprite", sprite_program::create);
+    scene->sprite_pr->set_atlas(resources.acquire_atlas(actor_sprite_files));
+    scene->actors_batch = make_actor_batch("actors");
+
+    return scene;
+}
+
+void render_game(game_data& game, game_scene& scene, rendering_context& ctx) {
+    update_actor_batches(game, *scene.actors_batch);
+    actor_data& hero = *game.heroes_data[scene.hero];
+    scene.cam->set_position(vector3(hero.pos_fx, hero.pos_fy, 0));
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (ctx.gpu) ctx.gpu->begin(gpu_pass::maze);
+    scene.cam->render(scene.maze_group, ctx, scene.maze_pr);
+    ctx.queue->flush();
+    if (ctx.gpu) ctx.gpu->end(gpu_pass::maze);
+    gl_state& state = gl_state::get();
+    state.disable(GL_DEPTH_TEST);
+    state.enable(GL_BLEND);
+    state.blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    if (ctx.gpu) ctx.gpu->begin(gpu_pass::actors);
+    scene.cam->render(scene.actors_batch->root, ctx, scene.sprite_pr);
+    ctx.queue->flush();
+    if (ctx.gpu) ctx.gpu->end(gpu_pass::actors);
+    state.disable(GL_BLEND);
+}
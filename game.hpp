@@ -0,0 +1,141 @@
+#ifndef _game_hpp_
+#define _game_hpp_
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "amazing.hpp"
+#include "graph.hpp"
+#include "program.hpp"
+#include "arena.hpp"
+
+// The play scene without its window: the simulation of the actors and the
+// rendering of the maze and actor passes. play() drives it from the
+// keyboard, the render benchmark drives it offscreen and the batch runner
+// steps the simulation alone.
+
+enum class direction {
+    none, up, down, right, left
+};
+
+enum class actor_nature {
+    good, evil
+};
+
+struct actor_data {
+    int pos_x;
+    int pos_y;
+    float pos_fx;
+    float pos_fy;
+    direction dir;
+    direction next_direction;
+    float inc;
+    actor_nature nature;
+};
+
+// the steps of the actors, each a divisor of a cell
+static const float hero_inc = 0.1f;
+static const float bad_guy_inc = 0.05f;
+
+// All the actors, drawn with a single instanced call of the shared actor
+// quad. Each instance selects its sprite in the actors atlas.
+struct actor_batch {
+    std::shared_ptr<geometry<float>> quad;
+    std::shared_ptr<group> root;
+    vertex_layout layout;
+    std::vector<float> instances;
+};
+
+// The simulation of a game, without GL: it runs on any thread and a seed
+// replays it.
+struct game_data {
+    game_data(maze_model& model, unsigned seed) : model(model), random(seed), tick(0) {}
+    maze_model& model;
+    rng random;
+    long tick;
+    // transient buffers of the bad guys' path finding, the loop driving
+    // the game resets it at the top of every frame
+    frame_arena arena;
+    // one hero per player
+    std::vector<std::shared_ptr<actor_data>> heroes_data;
+    std::vector<std::shared_ptr<actor_data>> bad_guys_data;
+};
+
+enum class game_outcome {
+    running, won, lost
+};
+
+// how the maze is drawn: a quad per wall, or a quad over the whole maze
+// testing a texture of the walls per pixel
+enum class maze_renderer {
+    geometry, grid
+};
+
+// the GL side of a game
+struct game_scene {
+    // the hero the camera follows
+    int hero;
+    std::shared_ptr<camera> cam;
+    std::shared_ptr<node> maze_group;
+    std::shared_ptr<program> maze_pr;
+    std::shared_ptr<sprite_program> sprite_pr;
+    std::shared_ptr<actor_batch> actors_batch;
+    // only the one matching the maze_renderer is set
+    std::shared_ptr<mutable_maze_geometry_2d> maze;
+    std::shared_ptr<maze_grid_2d> maze_grid;
+};
+
+std::shared_ptr<camera> create_game_camera(int width, int height);
+
+// bad_guys < 0 spawns the usual number for the maze size
+std::shared_ptr<game_data> make_game_data(maze_model& model, unsigned seed, int bad_guys = -1, int heroes = 1);
+
+// moves the actors by one frame and lets the bad guys choose their way
+void update_game(game_data& game);
+
+// The way from src to dest, if there is one shorter than best steps. The
+// search takes its buffer from game.arena.
+direction get_best_direction(game_data& game, pos src, pos dest, int best);
+
+// what update_game does for the bad guys once they moved: the search, then
+// the wandering
+void update_bad_guys_directions(game_data& game);
+
+// The search of update_bad_guys_directions without changing the bad guys.
+// chasing tells which bad guys are near enough to a hero to chase the
+// closest one, ways their way to it, none when the search found no short
+// one. Both arrays have a slot per bad guy. The search takes its buffer
+// from game.arena.
+void find_chasing_directions(game_data& game, direction* ways, bool* chasing);
+
+// a random way for each bad guy that has none
+void wander(game_data& game);
+
+// what update_game does before the bad guys choose their way
+void move_actors(game_data& game);
+
+// a hero wandering, taking a random open way at every cell
+direction bot_direction(game_data& game, const actor_data& hero, rng& random);
+
+// won as soon as a hero gets out, lost as soon as one is caught
+game_outcome get_outcome(game_data& game);
+
+// the state of the actors and the generator, for comparing two runs of a
+// game
+uint32_t game_checksum(game_data& game);
+
+// changes a wall in the model and in the maze being drawn
+void set_wall(game_data& game, game_scene& scene, int x, int y, bool wall);
+
+// uploads the whole maze being drawn, after many walls of the model changed
+void walls_changed(game_scene& scene);
+
+std::shared_ptr<game_scene> make_game_scene(game_data& game, const color& col, int width, int height,
+                                            maze_renderer renderer = maze_renderer::grid);
+
+// draws the maze and the actors through ctx.queue, which must be set
+void render_game(game_data& game, game_scene& scene, rendering_context& ctx);
+
+#endif
@@ -1,117 +1,315 @@
-#ifndef _geometry_hpp_
-#define _geometry_hpp_
-
-#include <vector>
-#include <memory>
-#include <GL/glew.h>
-
-enum vertex_attribute {
-    POSITION,
-    TEXCOORD,
-    NORMAL
-};
-
-template<class T>
-class geometry {
-
-public:
-	geometry(GLsizei count_) :
-        count(count_), positions_id(0), tex_coords_id(0), normals_id(0) {}
-	
-	~geometry() {
-        glDeleteBuffers(1, &positions_id);
-        glDeleteBuffers(1, &tex_coords_id);
-        glDeleteBuffers(1, &normals_id);
-    }
-
-	void set_vertex_positions(GLuint positionsId_) {
-        positions_id = positionsId_;
-    }
-
-    void set_vertex_tex_coords(GLuint texCoordsId_) {
-        tex_coords_id = texCoordsId_;
-    }
-
-    void set_vertex_normals(GLuint normalsId_) {
-        normals_id = normalsId_;
-    }
-
-    void set_vertex_positions(void* data, long size) {
-        glGenBuffers(1, &positions_id);
-        glBindBuffer(GL_ARRAY_BUFFER, positions_id);
-        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
-    }
-
-	void set_vertex_tex_coords(void* data, long size) {
-        glGenBuffers(1, &tex_coords_id);
-        glBindBuffer(GL_ARRAY_BUFFER, tex_coords_id);
-        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
-    }
-
-    void set_vertex_normals(void* data, long size) {
-        glGenBuffers(1, &normals_id);
-        glBindBuffer(GL_ARRAY_BUFFER, normals_id);
-        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
-    }
-
-    GLuint get_positions_id() const {
-        return positions_id;
-    }
-
-    GLuint get_tex_coords_id() const {
-        return tex_coords_id;
-    }
-
-    GLuint get_normals_id() const {
-        return normals_id;
-    }
-
-    GLsizei get_count() const {
-        return count;
-    }
-
-private:
-	GLuint positions_id;
-	GLuint tex_coords_id;
-	GLuint normals_id;
-    GLsizei count;
-
-};
-
-template <class T>
-class buffer_object_builder {
-
-public:
-
-    void* get_data() {
-        return &data[0];
-    }
-
-    GLsizeiptr get_size() {
-        return data.size() * sizeof(T);
-    }
-
-    GLsizeiptr get_count() {
-        return data.size();
-    }
-
-    GLuint build() {
-        GLuint id;
-        glGenBuffers(1, &id);
-        glBindBuffer(GL_ARRAY_BUFFER, id);
-        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(T), &data[0], GL_STATIC_DRAW);
-        return id;
-    }
-
-    buffer_object_builder<T>& operator<<(T t) {
-        data.push_back(t);
-        return *this;
-    }
-
-private:
-
-    std::vector<T> data;
-
-};
-
-#endif
+#ifndef _geometry_hpp_
+#define _geometry_hpp_
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <GL/glew.h>
+
+#include "state.hpp"
+#include "gl_stats.hpp"
+
+enum vertex_attribute {
+    POSITION,
+    TEXCOORD,
+    NORMAL,
+    INSTANCE
+};
+
+// Describes how vertex attributes are laid out in an interleaved buffer.
+// Sizes, offsets and stride are expressed in components, not in bytes.
+struct vertex_layout {
+    struct element {
+        vertex_attribute attribute;
+        GLint size;
+        GLsizei offset;
+    };
+
+    vertex_layout() : stride(0) {}
+
+    vertex_layout& add(vertex_attribute attribute, GLint size) {
+        elements.push_back(element{ attribute, size, stride });
+        stride += size;
+        return *this;
+    }
+
+    const element* find(vertex_attribute attribute) const {
+        for (auto& e : elements) {
+            if (e.attribute == attribute) return &e;
+        }
+        return nullptr;
+    }
+
+    // identifies the attribute set, so that programs consuming the same
+    // attributes share a vertex array object
+    unsigned key() const {
+        unsigned k = 0;
+        for (auto& e : elements) {
+            k |= (unsigned)e.size << (e.attribute * 3);
+        }
+        return k;
+    }
+
+    GLsizei stride;
+    std::vector<element> elements;
+};
+
+// a run of vertices in a geometry
+struct vertex_range {
+    GLsizei first;
+    GLsizei count;
+};
+
+template<class T>
+class geometry {
+
+public:
+	geometry(GLsizei count_) :
+        positions_id(0), tex_coords_id(0), normals_id(0), vertices_id(0), instances_id(0), instance_count(0),
+        usage(GL_STATIC_DRAW), vertex_arrays_generation(gl_state::get().get_generation()), count(count_) {}
+	
+	~geometry() {
+        release_vertex_arrays();
+        glDeleteBuffers(1, &positions_id);
+        glDeleteBuffers(1, &tex_coords_id);
+        glDeleteBuffers(1, &normals_id);
+        glDeleteBuffers(1, &vertices_id);
+        glDeleteBuffers(1, &instances_id);
+        gl_state::get().invalidate();
+    }
+
+	void set_vertex_positions(GLuint positionsId_) {
+        positions_id = positionsId_;
+    }
+
+    void set_vertex_tex_coords(GLuint texCoordsId_) {
+        tex_coords_id = texCoordsId_;
+    }
+
+    void set_vertex_normals(GLuint normalsId_) {
+        normals_id = normalsId_;
+    }
+
+    void set_vertex_positions(void* data, long size) {
+        glGenBuffers(1, &positions_id);
+        gl_state::get().bind_buffer(GL_ARRAY_BUFFER, positions_id);
+        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        gl_stats::get().upload(size);
+    }
+
+	void set_vertex_tex_coords(void* data, long size) {
+        glGenBuffers(1, &tex_coords_id);
+        gl_state::get().bind_buffer(GL_ARRAY_BUFFER, tex_coords_id);
+        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        gl_stats::get().upload(size);
+    }
+
+    void set_vertex_normals(void* data, long size) {
+        glGenBuffers(1, &normals_id);
+        gl_state::get().bind_buffer(GL_ARRAY_BUFFER, normals_id);
+        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        gl_stats::get().upload(size);
+    }
+
+    void set_vertices(void* data, long size, const vertex_layout& layout_, GLenum usage_ = GL_STATIC_DRAW) {
+        layout = layout_;
+        usage = usage_;
+        glGenBuffers(1, &vertices_id);
+        gl_state::get().bind_buffer(GL_ARRAY_BUFFER, vertices_id);
+        glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+        gl_stats::get().upload(size);
+    }
+
+    // Replaces the vertices of the interleaved buffer, keeping its layout and
+    // usage, the count may change.
+    void reset_vertices(const void* data, long size, GLsizei count_) {
+        count = count_;
+        gl_state::get().bind_buffer(GL_ARRAY_BUFFER, vertices_id);
+        glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+        gl_stats::get().upload(size);
+    }
+
+    // Overwrites some vertices of the interleaved buffer in place, data holds
+    // range.count vertices laid out as given to set_vertices.
+    void update_vertices(vertex_range range, const void* data) {
+        GLsizeiptr vertex_size = layout.stride * sizeof(T);
+        gl_state::get().bind_buffer(GL_ARRAY_BUFFER, vertices_id);
+        glBufferSubData(GL_ARRAY_BUFFER, range.first * vertex_size, range.count * vertex_size, data);
+        gl_stats::get().upload(range.count * vertex_size);
+    }
+
+    // Per instance attributes, advanced once per instance instead of once per
+    // vertex. Meant to be refreshed every frame, the buffer is reused.
+    void set_instances(const void* data, long size, const vertex_layout& layout_, GLsizei count_) {
+        if (instances_id == 0) {
+            glGenBuffers(1, &instances_id);
+            // the existing vertex arrays do not know about the instance buffer
+            release_vertex_arrays();
+        }
+        instance_layout = layout_;
+        instance_count = count_;
+        gl_state::get().bind_buffer(GL_ARRAY_BUFFER, instances_id);
+        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STREAM_DRAW);
+        gl_stats::get().upload(size);
+    }
+
+    // Issues the draw call, instanced if the geometry has instances. The
+    // vertex array must be bound.
+    void draw(GLenum mode) const {
+        if (instances_id != 0) {
+            glDrawArraysInstanced(mode, 0, count, instance_count);
+            gl_stats::get().draw((long) count * instance_count);
+        } else {
+            glDrawArrays(mode, 0, count);
+            gl_stats::get().draw(count);
+        }
+    }
+
+    // Draws copies of a geometry without instances in one call, the shader
+    // tells them apart by gl_InstanceID. The vertex array must be bound.
+    void draw_copies(GLenum mode, GLsizei copies) const {
+        glDrawArraysInstanced(mode, 0, count, copies);
+        gl_stats::get().draw((long) count * copies);
+    }
+
+    // Returns the vertex array object feeding the given program inputs,
+    // creating it on first use. Attributes come from the interleaved buffer
+    // when there is one, from the separate buffers otherwise.
+    GLuint get_vertex_array(const vertex_layout& inputs) const {
+        gl_state& state = gl_state::get();
+        if (vertex_arrays_generation != state.get_generation()) {
+            // the vertex arrays died with the context they were created in
+            vertex_arrays.clear();
+            vertex_arrays_generation = state.get_generation();
+        }
+        auto it = vertex_arrays.find(inputs.key());
+        if (it != vertex_arrays.end()) {
+            return it->second;
+        }
+        GLuint vao;
+        glGenVertexArrays(1, &vao);
+        state.bind_vertex_array(vao);
+        for (auto& input : inputs.elements) {
+            const vertex_layout::element* i = instance_layout.find(input.attribute);
+            if (instances_id != 0 && i != nullptr) {
+                state.bind_buffer(GL_ARRAY_BUFFER, instances_id);
+                glVertexAttribPointer(input.attribute, i->size, GL_FLOAT, GL_FALSE,
+                                      instance_layout.stride * sizeof(T), (void*)(i->offset * sizeof(T)));
+                glVertexAttribDivisor(input.attribute, 1);
+            } else if (vertices_id != 0) {
+                const vertex_layout::element* e = layout.find(input.attribute);
+                if (e == nullptr) continue;
+                state.bind_buffer(GL_ARRAY_BUFFER, vertices_id);
+                glVertexAttribPointer(input.attribute, e->size, GL_FLOAT, GL_FALSE,
+                                      layout.stride * sizeof(T), (void*)(e->offset * sizeof(T)));
+            } else {
+                state.bind_buffer(GL_ARRAY_BUFFER, get_buffer_id(input.attribute));
+                glVertexAttribPointer(input.attribute, input.size, GL_FLOAT, GL_FALSE, 0, 0);
+            }
+            glEnableVertexAttribArray(input.attribute);
+        }
+        vertex_arrays[inputs.key()] = vao;
+        return vao;
+    }
+
+    GLuint get_vertices_id() const {
+        return vertices_id;
+    }
+
+    const vertex_layout& get_layout() const {
+        return layout;
+    }
+
+    GLuint get_positions_id() const {
+        return positions_id;
+    }
+
+    GLuint get_tex_coords_id() const {
+        return tex_coords_id;
+    }
+
+    GLuint get_normals_id() const {
+        return normals_id;
+    }
+
+    GLsizei get_count() const {
+        return count;
+    }
+
+    GLsizei get_instance_count() const {
+        return instance_count;
+    }
+
+private:
+    GLuint get_buffer_id(vertex_attribute attribute) const {
+        switch (attribute) {
+        case POSITION: return positions_id;
+        case TEXCOORD: return tex_coords_id;
+        case NORMAL: return normals_id;
+        default: return 0;
+        }
+    }
+
+    void release_vertex_arrays() const {
+        if (vertex_arrays_generation == gl_state::get().get_generation()) {
+            for (auto& vao : vertex_arrays) {
+                glDeleteVertexArrays(1, &vao.second);
+            }
+        }
+        vertex_arrays.clear();
+        gl_state::get().invalidate();
+    }
+
+	GLuint positions_id;
+	GLuint tex_coords_id;
+	GLuint normals_id;
+    GLuint vertices_id;
+    GLuint instances_id;
+    GLsizei instance_count;
+    vertex_layout layout;
+    GLenum usage;
+    vertex_layout instance_layout;
+    mutable std::map<unsigned, GLuint> vertex_arrays;
+    mutable unsigned vertex_arrays_generation;
+    GLsizei count;
+
+};
+
+template <class T>
+class buffer_object_builder {
+
+public:
+
+    void* get_data() {
+        return &data[0];
+    }
+
+    GLsizeiptr get_size() {
+        return data.size() * sizeof(T);
+    }
+
+    GLsizeiptr get_count() {
+        return data.size();
+    }
+
+    GLuint build() {
+        GLuint id;
+        glGenBuffers(1, &id);
+        gl_state::get().bind_buffer(GL_ARRAY_BUFFER, id);
+        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(T), &data[0], GL_STATIC_DRAW);
+        gl_stats::get().upload(data.size() * sizeof(T));
+        return id;
+    }
+
+    buffer_object_builder<T>& operator<<(T t) {
+        data.push_back(t);
+        return *this;
+    }
+
+private:
+
+    std::vector<T> data;
+
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <sstream>
+
+#include "gl_stats.hpp"
+
+static const gl_counts no_counts = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+gl_stats& gl_stats::get() {
+    static gl_stats stats;
+    return stats;
+}
+
+gl_stats::gl_stats() {
+    reset();
+}
+
+void gl_stats::end_frame() {
+    last = current;
+    totals.draws += current.draws;
+    totals.vertices += current.vertices;
+    totals.material_binds += current.material_binds;
+    totals.program_binds += current.program_binds;
+    totals.texture_binds += current.texture_binds;
+    totals.buffer_binds += current.buffer_binds;
+    totals.vertex_array_binds += current.vertex_array_binds;
+    totals.uniforms += current.uniforms;
+    totals.uploaded_bytes += current.uploaded_bytes;
+    current = no_counts;
+    frames++;
+}
+
+const gl_counts& gl_stats::get_last_frame() const {
+    return last;
+}
+
+const gl_counts& gl_stats::get_totals() const {
+    return totals;
+}
+
+long gl_stats::get_frames() const {
+    return frames;
+}
+
+void gl_stats::reset() {
+    current = no_counts;
+    last = no_counts;
+    totals = no_counts;
+    frames = 0;
+}
+
+std::string format_gl_counts(const gl_counts& counts) {
+    std::ostringstream out;
+    out << "draws " << counts.draws << "\n"
+        << "vertices " << counts.vertices << "\n"
+        << "material binds " << counts.material_binds << "\n"
+        << "program binds " << counts.program_binds << "\n"
+        << "texture binds " << counts.texture_binds << "\n"
+        << "buffer binds " << counts.buffer_binds << "\n"
+        << "vertex array binds " << counts.vertex_array_binds << "\n"
+        << "uniforms " << counts.uniforms << "\n"
+        << "uploaded " << counts.uploaded_bytes << " bytes";
+    return out.str();
+}
+
+void print_gl_totals() {
+    gl_stats& stats = gl_stats::get();
+    const gl_counts& t = stats.get_totals();
+    long frames = stats.get_frames();
+    if (frames == 0) return;
+    std::cout << "frames=" << frames
+              << " draws=" << t.draws << " (" << (double) t.draws / frames << "/frame)"
+              << " vertices=" << t.vertices << " (" << (double) t.vertices / frames << "/frame)"
+              << " material_binds=" << t.material_binds
+              << " program_binds=" << t.program_binds
+              << " texture_binds=" << t.texture_binds
+              << " buffer_binds=" << t.buffer_binds
+              << " vertex_array_binds=" << t.vertex_array_binds
+              << " uniforms=" << t.uniforms << " (" << (double) t.uniforms / frames << "/frame)"
+              << " uploaded_bytes=" << t.uploaded_bytes
+              << std::endl;
+}
@@ -0,0 +1,61 @@
+#ifndef _gl_stats_hpp_
+#define _gl_stats_hpp_
+
+#include <string>
+
+// What a frame asked of GL, counted where the calls are made: draws and
+// vertices by geometry, binds and uniforms by gl_state (the redundant binds
+// it skips are not counted), the materials bound by the render queue and
+// uploads by geometry and texture. Many draws with few vertices point to a
+// frame bound by draw calls, few draws with a slow frame to one bound by fill
+// rate.
+struct gl_counts {
+    long draws;
+    long vertices;
+    // the program and material changes of the render queue's flushes
+    long material_binds;
+    long program_binds;
+    long texture_binds;
+    long buffer_binds;
+    long vertex_array_binds;
+    long uniforms;
+    long uploaded_bytes;
+};
+
+class gl_stats {
+public:
+    static gl_stats& get();
+
+    void draw(long vertices) {
+        current.draws++;
+        current.vertices += vertices;
+    }
+    void material_bind() { current.material_binds++; }
+    void program_bind() { current.program_binds++; }
+    void texture_bind() { current.texture_binds++; }
+    void buffer_bind() { current.buffer_binds++; }
+    void vertex_array_bind() { current.vertex_array_binds++; }
+    void uniform() { current.uniforms++; }
+    void upload(long bytes) { current.uploaded_bytes += bytes; }
+
+    // closes the frame, its counts become the last frame's and go to the totals
+    void end_frame();
+    const gl_counts& get_last_frame() const;
+    const gl_counts& get_totals() const;
+    long get_frames() const;
+    void reset();
+private:
+    gl_stats();
+    gl_stats(const gl_stats&);
+    gl_counts current;
+    gl_counts last;
+    gl_counts totals;
+    long frames;
+};
+
+// one line per count, for the overlay
+std::string format_gl_counts(const gl_counts& counts);
+// the totals and the means of a frame
+void print_gl_totals();
+
+#endif
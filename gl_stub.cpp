@@ -0,0 +1,210 @@
+#include <GL/glew.h>
+
+#include "gl_stub.hpp"
+
+static gl_stub_counts counts;
+static GLuint next_name = 1;
+
+const gl_stub_counts& gl_stub_get_counts() {
+    return counts;
+}
+
+void gl_stub_reset_counts() {
+    counts = gl_stub_counts();
+}
+
+static void call() { counts.calls++; }
+static void state() { counts.calls++; counts.state++; }
+static void uniform() { counts.calls++; counts.uniforms++; }
+static void upload(long bytes) { counts.calls++; counts.uploaded += bytes; }
+
+static void generate(GLsizei n, GLuint* names) {
+    call();
+    for (GLsizei i = 0; i < n; i++) {
+        names[i] = next_name++;
+    }
+}
+
+static long texture_bytes(GLsizei width, GLsizei height, GLenum format) {
+    int components = format == GL_RED ? 1 : format == GL_RGB ? 3 : 4;
+    return (long) width * height * components;
+}
+
+// GL 1.1, which GLEW leaves to libGL
+
+GLenum GLAPIENTRY glGetError() { call(); return GL_NO_ERROR; }
+const GLubyte* GLAPIENTRY glGetString(GLenum) { call(); return (const GLubyte*) "gl stub"; }
+void GLAPIENTRY glGetIntegerv(GLenum, GLint* params) { call(); *params = 0; }
+void GLAPIENTRY glViewport(GLint, GLint, GLsizei, GLsizei) { state(); }
+void GLAPIENTRY glClear(GLbitfield) { call(); }
+void GLAPIENTRY glFinish() { call(); }
+void GLAPIENTRY glEnable(GLenum) { state(); }
+void GLAPIENTRY glDisable(GLenum) { state(); }
+void GLAPIENTRY glBlendFunc(GLenum, GLenum) { state(); }
+void GLAPIENTRY glFrontFace(GLenum) { state(); }
+void GLAPIENTRY glPixelStorei(GLenum, GLint) { state(); }
+void GLAPIENTRY glGenTextures(GLsizei n, GLuint* textures) { generate(n, textures); }
+void GLAPIENTRY glDeleteTextures(GLsizei, const GLuint*) { call(); }
+void GLAPIENTRY glBindTexture(GLenum, GLuint) { state(); }
+void GLAPIENTRY glTexParameteri(GLenum, GLenum, GLint) { state(); }
+void GLAPIENTRY glTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum, const GLvoid*) {
+    upload(texture_bytes(width, height, format));
+}
+void GLAPIENTRY glTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum, const GLvoid*) {
+    upload(texture_bytes(width, height, format));
+}
+void GLAPIENTRY glReadPixels(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, GLvoid*) { call(); }
+void GLAPIENTRY glDrawArrays(GLenum, GLint, GLsizei count) {
+    call();
+    counts.draws++;
+    counts.vertices += count;
+}
+
+// the entry points GLEW loads
+
+static void GLAPIENTRY stub_gen_buffers(GLsizei n, GLuint* buffers) { generate(n, buffers); }
+static void GLAPIENTRY stub_delete_buffers(GLsizei, const GLuint*) { call(); }
+static void GLAPIENTRY stub_bind_buffer(GLenum, GLuint) { state(); }
+static void GLAPIENTRY stub_buffer_data(GLenum, GLsizeiptr size, const GLvoid*, GLenum) { upload((long) size); }
+static void GLAPIENTRY stub_buffer_sub_data(GLenum, GLintptr, GLsizeiptr size, const GLvoid*) { upload((long) size); }
+static GLvoid* GLAPIENTRY stub_map_buffer(GLenum, GLenum) { call(); return nullptr; }
+static GLboolean GLAPIENTRY stub_unmap_buffer(GLenum) { call(); return GL_TRUE; }
+static void GLAPIENTRY stub_gen_vertex_arrays(GLsizei n, GLuint* arrays) { generate(n, arrays); }
+static void GLAPIENTRY stub_delete_vertex_arrays(GLsizei, const GLuint*) { call(); }
+static void GLAPIENTRY stub_bind_vertex_array(GLuint) { state(); }
+static void GLAPIENTRY stub_enable_vertex_attrib_array(GLuint) { state(); }
+static void GLAPIENTRY stub_vertex_attrib_pointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const GLvoid*) { state(); }
+static void GLAPIENTRY stub_vertex_attrib_divisor(GLuint, GLuint) { state(); }
+static void GLAPIENTRY stub_draw_arrays_instanced(GLenum, GLint, GLsizei count, GLsizei instances) {
+    call();
+    counts.draws++;
+    counts.vertices += (long) count * instances;
+}
+static void GLAPIENTRY stub_active_texture(GLenum) { state(); }
+static void GLAPIENTRY stub_generate_mipmap(GLenum) { call(); }
+
+static GLuint GLAPIENTRY stub_create_shader(GLenum) { call(); return next_name++; }
+static void GLAPIENTRY stub_delete_shader(GLuint) { call(); }
+static void GLAPIENTRY stub_shader_source(GLuint, GLsizei, const GLchar* const*, const GLint*) { call(); }
+static void GLAPIENTRY stub_compile_shader(GLuint) { call(); }
+static void GLAPIENTRY stub_get_shader_iv(GLuint, GLenum name, GLint* params) {
+    call();
+    *params = name == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+static void GLAPIENTRY stub_get_shader_info_log(GLuint, GLsizei, GLsizei* length, GLchar* log) {
+    call();
+    if (length) *length = 0;
+    if (log) log[0] = 0;
+}
+static GLuint GLAPIENTRY stub_create_program() { call(); return next_name++; }
+static void GLAPIENTRY stub_delete_program(GLuint) { call(); }
+static void GLAPIENTRY stub_attach_shader(GLuint, GLuint) { call(); }
+static void GLAPIENTRY stub_detach_shader(GLuint, GLuint) { call(); }
+static void GLAPIENTRY stub_bind_attrib_location(GLuint, GLuint, const GLchar*) { call(); }
+static void GLAPIENTRY stub_link_program(GLuint) { call(); }
+static void GLAPIENTRY stub_get_program_iv(GLuint, GLenum name, GLint* params) {
+    call();
+    *params = name == GL_LINK_STATUS ? GL_TRUE : 0;
+}
+static void GLAPIENTRY stub_get_program_info_log(GLuint, GLsizei, GLsizei* length, GLchar* log) {
+    call();
+    if (length) *length = 0;
+    if (log) log[0] = 0;
+}
+static void GLAPIENTRY stub_program_parameter_i(GLuint, GLenum, GLint) { call(); }
+static void GLAPIENTRY stub_get_program_binary(GLuint, GLsizei, GLsizei* length, GLenum*, GLvoid*) {
+    call();
+    if (length) *length = 0;
+}
+static void GLAPIENTRY stub_program_binary(GLuint, GLenum, const GLvoid*, GLsizei) { call(); }
+static void GLAPIENTRY stub_use_program(GLuint) { state(); }
+static GLint GLAPIENTRY stub_get_uniform_location(GLuint, const GLchar*) { call(); return 0; }
+static void GLAPIENTRY stub_uniform_1i(GLint, GLint) { uniform(); }
+static void GLAPIENTRY stub_uniform_3f(GLint, GLfloat, GLfloat, GLfloat) { uniform(); }
+static void GLAPIENTRY stub_uniform_4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) { uniform(); }
+static void GLAPIENTRY stub_uniform_4fv(GLint, GLsizei, const GLfloat*) { uniform(); }
+static void GLAPIENTRY stub_uniform_matrix_4fv(GLint, GLsizei, GLboolean, const GLfloat*) { uniform(); }
+
+static void GLAPIENTRY stub_gen_framebuffers(GLsizei n, GLuint* framebuffers) { generate(n, framebuffers); }
+static void GLAPIENTRY stub_delete_framebuffers(GLsizei, const GLuint*) { call(); }
+static void GLAPIENTRY stub_bind_framebuffer(GLenum, GLuint) { state(); }
+static GLenum GLAPIENTRY stub_check_framebuffer_status(GLenum) { call(); return GL_FRAMEBUFFER_COMPLETE; }
+static void GLAPIENTRY stub_framebuffer_renderbuffer(GLenum, GLenum, GLenum, GLuint) { call(); }
+static void GLAPIENTRY stub_gen_renderbuffers(GLsizei n, GLuint* renderbuffers) { generate(n, renderbuffers); }
+static void GLAPIENTRY stub_delete_renderbuffers(GLsizei, const GLuint*) { call(); }
+static void GLAPIENTRY stub_bind_renderbuffer(GLenum, GLuint) { state(); }
+static void GLAPIENTRY stub_renderbuffer_storage(GLenum, GLenum, GLsizei, GLsizei) { call(); }
+static void GLAPIENTRY stub_gen_queries(GLsizei n, GLuint* ids) { generate(n, ids); }
+static void GLAPIENTRY stub_delete_queries(GLsizei, const GLuint*) { call(); }
+static void GLAPIENTRY stub_begin_query(GLenum, GLuint) { call(); }
+static void GLAPIENTRY stub_end_query(GLenum) { call(); }
+static void GLAPIENTRY stub_get_query_object_iv(GLuint, GLenum, GLint* params) { call(); *params = 1; }
+static void GLAPIENTRY stub_get_query_object_ui64v(GLuint, GLenum, GLuint64* params) { call(); *params = 0; }
+
+// the prototypes of a few entry points differ between GLEW versions by
+// their constness, hence the casts
+PFNGLGENBUFFERSPROC __glewGenBuffers = stub_gen_buffers;
+PFNGLDELETEBUFFERSPROC __glewDeleteBuffers = stub_delete_buffers;
+PFNGLBINDBUFFERPROC __glewBindBuffer = stub_bind_buffer;
+PFNGLBUFFERDATAPROC __glewBufferData = (PFNGLBUFFERDATAPROC) stub_buffer_data;
+PFNGLBUFFERSUBDATAPROC __glewBufferSubData = (PFNGLBUFFERSUBDATAPROC) stub_buffer_sub_data;
+PFNGLMAPBUFFERPROC __glewMapBuffer = (PFNGLMAPBUFFERPROC) stub_map_buffer;
+PFNGLUNMAPBUFFERPROC __glewUnmapBuffer = stub_unmap_buffer;
+PFNGLGENVERTEXARRAYSPROC __glewGenVertexArrays = stub_gen_vertex_arrays;
+PFNGLDELETEVERTEXARRAYSPROC __glewDeleteVertexArrays = stub_delete_vertex_arrays;
+PFNGLBINDVERTEXARRAYPROC __glewBindVertexArray = stub_bind_vertex_array;
+PFNGLENABLEVERTEXATTRIBARRAYPROC __glewEnableVertexAttribArray = stub_enable_vertex_attrib_array;
+PFNGLVERTEXATTRIBPOINTERPROC __glewVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC) stub_vertex_attrib_pointer;
+PFNGLVERTEXATTRIBDIVISORPROC __glewVertexAttribDivisor = stub_vertex_attrib_divisor;
+PFNGLDRAWARRAYSINSTANCEDPROC __glewDrawArraysInstanced = stub_draw_arrays_instanced;
+PFNGLACTIVETEXTUREPROC __glewActiveTexture = stub_active_texture;
+PFNGLGENERATEMIPMAPPROC __glewGenerateMipmap = stub_generate_mipmap;
+PFNGLCREATESHADERPROC __glewCreateShader = stub_create_shader;
+PFNGLDELETESHADERPROC __glewDeleteShader = stub_delete_shader;
+PFNGLSHADERSOURCEPROC __glewShaderSource = (PFNGLSHADERSOURCEPROC) stub_shader_source;
+PFNGLCOMPILESHADERPROC __glewCompileShader = stub_compile_shader;
+PFNGLGETSHADERIVPROC __glewGetShaderiv = stub_get_shader_iv;
+PFNGLGETSHADERINFOLOGPROC __glewGetShaderInfoLog = stub_get_shader_info_log;
+PFNGLCREATEPROGRAMPROC __glewCreateProgram = stub_create_program;
+PFNGLDELETEPROGRAMPROC __glewDeleteProgram = stub_delete_program;
+PFNGLATTACHSHADERPROC __glewAttachShader = stub_attach_shader;
+PFNGLDETACHSHADERPROC __glewDetachShader = stub_detach_shader;
+PFNGLBINDATTRIBLOCATIONPROC __glewBindAttribLocation = stub_bind_attrib_location;
+PFNGLLINKPROGRAMPROC __glewLinkProgram = stub_link_program;
+PFNGLGETPROGRAMIVPROC __glewGetProgramiv = stub_get_program_iv;
+PFNGLGETPROGRAMINFOLOGPROC __glewGetProgramInfoLog = stub_get_program_info_log;
+PFNGLPROGRAMPARAMETERIPROC __glewProgramParameteri = stub_program_parameter_i;
+PFNGLGETPROGRAMBINARYPROC __glewGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC) stub_get_program_binary;
+PFNGLPROGRAMBINARYPROC __glewProgramBinary = (PFNGLPROGRAMBINARYPROC) stub_program_binary;
+PFNGLUSEPROGRAMPROC __glewUseProgram = stub_use_program;
+PFNGLGETUNIFORMLOCATIONPROC __glewGetUniformLocation = stub_get_uniform_location;
+PFNGLUNIFORM1IPROC __glewUniform1i = stub_uniform_1i;
+PFNGLUNIFORM3FPROC __glewUniform3f = stub_uniform_3f;
+PFNGLUNIFORM4FPROC __glewUniform4f = stub_uniform_4f;
+PFNGLUNIFORM4FVPROC __glewUniform4fv = stub_uniform_4fv;
+PFNGLUNIFORMMATRIX4FVPROC __glewUniformMatrix4fv = stub_uniform_matrix_4fv;
+PFNGLGENFRAMEBUFFERSPROC __glewGenFramebuffers = stub_gen_framebuffers;
+PFNGLDELETEFRAMEBUFFERSPROC __glewDeleteFramebuffers = stub_delete_framebuffers;
+PFNGLBINDFRAMEBUFFERPROC __glewBindFramebuffer = stub_bind_framebuffer;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC __glewCheckFramebufferStatus = stub_check_framebuffer_status;
+PFNGLFRAMEBUFFERRENDERBUFFERPROC __glewFramebufferRenderbuffer = stub_framebuffer_renderbuffer;
+PFNGLGENRENDERBUFFERSPROC __glewGenRenderbuffers = stub_gen_renderbuffers;
+PFNGLDELETERENDERBUFFERSPROC __glewDeleteRenderbuffers = stub_delete_renderbuffers;
+PFNGLBINDRENDERBUFFERPROC __glewBindRenderbuffer = stub_bind_renderbuffer;
+PFNGLRENDERBUFFERSTORAGEPROC __glewRenderbufferStorage = stub_renderbuffer_storage;
+PFNGLGENQUERIESPROC __glewGenQueries = stub_gen_queries;
+PFNGLDELETEQUERIESPROC __glewDeleteQueries = stub_delete_queries;
+PFNGLBEGINQUERYPROC __glewBeginQuery = stub_begin_query;
+PFNGLENDQUERYPROC __glewEndQuery = stub_end_query;
+PFNGLGETQUERYOBJECTIVPROC __glewGetQueryObjectiv = stub_get_query_object_iv;
+PFNGLGETQUERYOBJECTUI64VPROC __glewGetQueryObjectui64v = stub_get_query_object_ui64v;
+
+// no extension, so that nothing is cached on disk and no pass is timed
+GLboolean __GLEW_VERSION_3_3 = GL_FALSE;
+GLboolean __GLEW_VERSION_4_1 = GL_FALSE;
+GLboolean __GLEW_ARB_get_program_binary = GL_FALSE;
+GLboolean __GLEW_ARB_timer_query = GL_FALSE;
+
+GLenum GLEWAPIENTRY glewInit() {
+    return GLEW_OK;
+}
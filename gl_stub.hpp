@@ -0,0 +1,23 @@
+#ifndef _gl_stub_hpp_
+#define _gl_stub_hpp_
+
+// A GL that counts the calls instead of making them, linked in place of
+// GLEW and libGL by the tools measuring the CPU side of rendering on hosts
+// without a display. The objects it generates are plain increasing names,
+// shaders always compile and programs always link.
+
+struct gl_stub_counts {
+    long calls;
+    long draws;
+    long vertices;
+    // binds, enables and the like
+    long state;
+    long uniforms;
+    // bytes given to buffers and textures
+    long uploaded;
+};
+
+const gl_stub_counts& gl_stub_get_counts();
+void gl_stub_reset_counts();
+
+#endif
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+#include "gpu_timer.hpp"
+
+const char* get_pass_name(gpu_pass pass) {
+    static const char* names[] = { "maze", "actors", "hud" };
+    return names[(int) pass];
+}
+
+bool gpu_timer::is_supported() {
+    return GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+}
+
+gpu_timer::gpu_timer() : frame(0) {
+    glGenQueries(ring * gpu_pass_count, &queries[0][0]);
+    // llvmpipe answers the first query of a context with a time far off the
+    // pass, that result is dropped there; other drivers keep every result
+    const char* renderer = (const char*) glGetString(GL_RENDERER);
+    bool drop_first = renderer != nullptr && strstr(renderer, "llvmpipe") != nullptr;
+    for (int i = 0; i < ring; i++) {
+        for (int p = 0; p < gpu_pass_count; p++) {
+            pending[i][p] = false;
+        }
+    }
+    for (int p = 0; p < gpu_pass_count; p++) {
+        running[p] = false;
+        started[p] = !drop_first;
+        last[p] = 0.0;
+        total[p] = 0.0;
+        samples[p] = 0;
+    }
+}
+
+gpu_timer::~gpu_timer() {
+    glDeleteQueries(ring * gpu_pass_count, &queries[0][0]);
+}
+
+void gpu_timer::begin(gpu_pass pass) {
+    int p = (int) pass;
+    if (pending[frame][p]) return;
+    glBeginQuery(GL_TIME_ELAPSED, queries[frame][p]);
+    running[p] = true;
+}
+
+void gpu_timer::end(gpu_pass pass) {
+    int p = (int) pass;
+    if (!running[p]) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    running[p] = false;
+    pending[frame][p] = true;
+}
+
+void gpu_timer::end_frame() {
+    // from the oldest frame, so that the last result is the latest
+    for (int k = 1; k <= ring; k++) {
+        int i = (frame + k) % ring;
+        for (int p = 0; p < gpu_pass_count; p++) {
+            if (!pending[i][p]) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(queries[i][p], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[i][p], GL_QUERY_RESULT, &ns);
+            pending[i][p] = false;
+            if (!started[p]) {
+                started[p] = true;
+                continue;
+            }
+            last[p] = ns * 1e-9;
+            total[p] += last[p];
+            samples[p]++;
+        }
+    }
+    frame = (frame + 1) % ring;
+}
+
+double gpu_timer::get_last_seconds(gpu_pass pass) const {
+    return last[(int) pass];
+}
+
+double gpu_timer::get_mean_seconds(gpu_pass pass) const {
+    int p = (int) pass;
+    return samples[p] == 0 ? 0.0 : total[p] / samples[p];
+}
+
+long gpu_timer::get_samples(gpu_pass pass) const {
+    return samples[(int) pass];
+}
+
+std::string format_frame_times(double cpu_seconds, const gpu_timer* gpu) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << "cpu " << cpu_seconds * 1000.0 << " ms";
+    if (gpu) {
+        for (int p = 0; p < gpu_pass_count; p++) {
+            gpu_pass pass = (gpu_pass) p;
+            if (gpu->get_samples(pass) == 0) continue;
+            out << "\n" << get_pass_name(pass) << " gpu " << gpu->get_last_seconds(pass) * 1000.0 << " ms";
+        }
+    }
+    return out.str();
+}
+
+void print_frame_times(double cpu_mean_seconds, const gpu_timer* gpu) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << "cpu_ms=" << cpu_mean_seconds * 1000.0;
+    if (gpu) {
+        for (int p = 0; p < gpu_pass_count; p++) {
+            gpu_pass pass = (gpu_pass) p;
+            if (gpu->get_samples(pass) == 0) continue;
+            out << " " << get_pass_name(pass) << "_gpu_ms=" << gpu->get_mean_seconds(pass) * 1000.0;
+        }
+    }
+    std::cout << out.str() << std::endl;
+}
@@ -0,0 +1,57 @@
+#ifndef _gpu_timer_hpp_
+#define _gpu_timer_hpp_
+
+#include <string>
+#include <GL/glew.h>
+
+enum class gpu_pass {
+    maze,
+    actors,
+    hud
+};
+
+static const int gpu_pass_count = 3;
+
+const char* get_pass_name(gpu_pass pass);
+
+// GPU time of the render passes, measured with GL_TIME_ELAPSED queries. The
+// queries of a frame are read back frames later, once the GPU is done with
+// them, so that the CPU never waits for it. A pass is not timed in a frame
+// whose query from ring frames before is still in flight. On llvmpipe the
+// first result of a pass is dropped, that driver gets it wrong. The passes must not overlap, and the queries die with the context.
+class gpu_timer {
+public:
+    static const int ring = 4;
+
+    // timer queries are core in GL 3.3
+    static bool is_supported();
+    gpu_timer();
+    ~gpu_timer();
+    void begin(gpu_pass pass);
+    void end(gpu_pass pass);
+    // reads the results that arrived, without waiting for the others
+    void end_frame();
+    // 0 before the first result
+    double get_last_seconds(gpu_pass pass) const;
+    double get_mean_seconds(gpu_pass pass) const;
+    long get_samples(gpu_pass pass) const;
+private:
+    gpu_timer(const gpu_timer&);
+    GLuint queries[ring][gpu_pass_count];
+    bool pending[ring][gpu_pass_count];
+    bool running[gpu_pass_count];
+    // false until the result to drop came
+    bool started[gpu_pass_count];
+    int frame;
+    double last[gpu_pass_count];
+    double total[gpu_pass_count];
+    long samples[gpu_pass_count];
+};
+
+// the CPU time of a frame and the GPU time of its passes, one line each, for
+// the overlay. gpu may be null.
+std::string format_frame_times(double cpu_seconds, const gpu_timer* gpu);
+// the means over a run
+void print_frame_times(double cpu_mean_seconds, const gpu_timer* gpu);
+
+#endif
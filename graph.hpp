@@ -1,84 +1,141 @@
-#ifndef _graph_hpp_
-#define _graph_hpp_
-
-#include <math.h>
-#include <vector>
-#include <memory>
-
-#include "matrix.hpp"
-#include "geometry.hpp"
-#include "texture.hpp"
-#include "program.hpp"
-#include "context.hpp"
-
-class node {
-public:
-    virtual void render(rendering_context& ctx) = 0;
-};
-
-struct clipping_volume {
-    float left;
-    float right;
-    float bottom;
-    float top;
-    float nearp;
-    float farp;
-};
-
-// cf http://www.codecolony.de/opengl.htm#camera2
-struct camera {
-    camera(const clipping_volume& clippingVolume);
-    virtual void render(std::shared_ptr<node> node, rendering_context& ctx, std::shared_ptr<program> program) = 0;
-    void reset();
-    void rotate_x(float deg);
-    void rotate_y(float deg);
-    void rotate_z(float deg);
-    void move_right(float dist);
-    void move_left(float dist);
-    void move_up(float dist);
-    void move_down(float dist);
-    void move_forward(float dist);
-    void move_backward(float dist);
-    matrix44 position_and_orient();
-    vector3 position_v;
-    vector3 direction_v;
-    vector3 right_v;
-    vector3 up_v;
-    clipping_volume cv;
-};
-
-class perspective_camera : public camera {
-public:
-    perspective_camera(const clipping_volume& cv);
-    virtual void render(std::shared_ptr<node> node, rendering_context& ctx, std::shared_ptr<program> program);
-};
-
-class parallel_camera : public camera {
-public:
-    parallel_camera(const clipping_volume& cv);
-    virtual void render(std::shared_ptr<node> node, rendering_context& ctx, std::shared_ptr<program> program);
-};
-
-class group : public node {
-public:
-    group();
-    void transformation(const matrix44& tr);
-    void add(std::shared_ptr<node> node);
-    virtual void render(rendering_context& ctx);
-protected:
-    std::vector<std::shared_ptr<node>> children;
-    matrix44 transform;
-};
-
-template<class T>
-class geometry_node : public node {
-public:
-    geometry_node(std::shared_ptr<geometry<T>> geom) : geom(geom) {}
-    virtual void render(rendering_context& ctx) {
-        ctx.prog->render(*geom, ctx);
-    }
-private:
-    std::shared_ptr<geometry<T>> geom;
-};
-
-#endif
+#ifndef _graph_hpp_
+#define _graph_hpp_
+
+#include <math.h>
+#include <vector>
+#include <memory>
+
+#include "matrix.hpp"
+#include "geometry.hpp"
+#include "texture.hpp"
+#include "program.hpp"
+#include "context.hpp"
+#include "queue.hpp"
+
+class compiled_group;
+
+class node {
+public:
+    virtual void render(rendering_context& ctx) = 0;
+    // appends this node to the flattened form of a graph, under the group
+    // at index parent
+    virtual void flatten(compiled_group& target, int parent) = 0;
+};
+
+struct clipping_volume {
+    float left;
+    float right;
+    float bottom;
+    float top;
+    float nearp;
+    float farp;
+};
+
+// cf http://www.codecolony.de/opengl.htm#camera2
+struct camera {
+    camera(const clipping_volume& clippingVolume);
+    virtual void render(std::shared_ptr<node> node, rendering_context& ctx, std::shared_ptr<program> program) = 0;
+    void reset();
+    void set_position(const vector3& position);
+    void rotate_x(float deg);
+    void rotate_y(float deg);
+    void rotate_z(float deg);
+    void move_right(float dist);
+    void move_left(float dist);
+    void move_up(float dist);
+    void move_down(float dist);
+    void move_forward(float dist);
+    void move_backward(float dist);
+    const matrix44& position_and_orient();
+    // the vectors are public for reading, moving the camera must go through
+    // the methods above so that the view matrix gets recomputed
+    vector3 position_v;
+    vector3 direction_v;
+    vector3 right_v;
+    vector3 up_v;
+    clipping_volume cv;
+protected:
+    matrix44 projection_m;
+private:
+    bool view_dirty;
+    matrix44 view_m;
+};
+
+class perspective_camera : public camera {
+public:
+    perspective_camera(const clipping_volume& cv);
+    virtual void render(std::shared_ptr<node> node, rendering_context& ctx, std::shared_ptr<program> program);
+};
+
+class parallel_camera : public camera {
+public:
+    parallel_camera(const clipping_volume& cv);
+    virtual void render(std::shared_ptr<node> node, rendering_context& ctx, std::shared_ptr<program> program);
+};
+
+class group : public node {
+public:
+    group();
+    void transformation(const matrix44& tr);
+    void add(std::shared_ptr<node> node);
+    virtual void render(rendering_context& ctx);
+    virtual void flatten(compiled_group& target, int parent);
+protected:
+    friend class compiled_group;
+    std::vector<std::shared_ptr<node>> children;
+    matrix44 transform;
+    // bumped by transformation(), tells compiled groups the transform is dirty
+    unsigned revision;
+};
+
+// Flattened form of a graph: the groups in contiguous arrays, parents
+// first, with their world transforms cached and only recomputed when a
+// group transformation, or one of its ancestors', changed. The structure
+// is captured at construction, compile again after adding nodes.
+class compiled_group : public node {
+public:
+    compiled_group(std::shared_ptr<node> root);
+    virtual void render(rendering_context& ctx);
+    virtual void flatten(compiled_group& target, int parent);
+    int add_group(group* g, int parent);
+    void add_leaf(node* n, int parent);
+private:
+    struct entry {
+        group* source;
+        int parent;
+        unsigned revision;
+        bool changed;
+    };
+    struct leaf {
+        node* source;
+        int parent;
+    };
+    std::shared_ptr<node> root;
+    std::vector<entry> groups;
+    std::vector<leaf> leaves;
+    // world, model view projection and model view matrices of the groups,
+    // kept apart from the entries so that they can be transformed in batch
+    std::vector<matrix44> worlds;
+    std::vector<matrix44> mvps;
+    std::vector<matrix44> mvs;
+};
+
+template<class T>
+class geometry_node : public node {
+public:
+    geometry_node(std::shared_ptr<geometry<T>> geom) : geom(geom) {}
+    virtual void render(rendering_context& ctx) {
+        if (ctx.queue) {
+            ctx.queue->push(*geom, ctx);
+        } else {
+            ctx.prog->render(*geom, ctx);
+        }
+    }
+    virtual void flatten(compiled_group& target, int parent) {
+        target.add_leaf(this, parent);
+    }
+private:
+    std::shared_ptr<geometry<T>> geom;
+};
+
+#endif
@@ -0,0 +1,14 @@
+#version 330
+
+uniform vec4 color;
+uniform sampler2D grid;
+
+in vec2 vcell;
+
+out vec4 fcolor;
+
+// one texel per cell, non zero for the walls
+void main(void) {
+	if (texelFetch(grid, ivec2(floor(vcell)), 0).r < 0.5f) discard;
+	fcolor = color;
+}
@@ -0,0 +1,12 @@
+#version 330
+
+uniform mat4 mvpMatrix;
+
+in vec2 vpos;
+
+out vec2 vcell;
+
+void main(void) {
+	gl_Position = mvpMatrix * vec4(vpos, 0.0f, 1.0f);
+	vcell = vpos;
+}
@@ -0,0 +1,87 @@
+#include <stdexcept>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "headless.hpp"
+#include "state.hpp"
+
+// what the framebuffer and the programs call beyond GL 1.1
+static bool has_entry_points() {
+    return glGenFramebuffers != nullptr && glGenRenderbuffers != nullptr &&
+           glCreateProgram != nullptr && glGenVertexArrays != nullptr &&
+           glDrawArraysInstanced != nullptr;
+}
+
+headless_context::headless_context(int width, int height) :
+    width(width), height(height), display(nullptr), context(nullptr),
+    framebuffer(0), color_buffer(0), depth_buffer(0)
+{
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display == nullptr) {
+        throw std::runtime_error("EGL_EXT_platform_base is not supported");
+    }
+    EGLDisplay dpy = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    EGLint major, minor;
+    if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, &major, &minor)) {
+        throw std::runtime_error("no surfaceless EGL display");
+    }
+    display = dpy;
+    eglBindAPI(EGL_OPENGL_API);
+    // the compatibility profile, the programs draw quads
+    EGLint attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext ctx = eglCreateContext(dpy, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+    if (ctx != EGL_NO_CONTEXT) context = ctx;
+    if (ctx == EGL_NO_CONTEXT || !eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx)) {
+        release();
+        throw std::runtime_error("cannot create a surfaceless OpenGL 3.3 context");
+    }
+    // without a GLX display GLEW reports an error, but the GL entry points
+    // are loaded by then: those needed must be there
+    GLenum glew = glewInit();
+    if (glew != GLEW_OK && !has_entry_points()) {
+        release();
+        throw std::runtime_error(std::string("cannot load the OpenGL entry points: ") +
+                                 (const char*) glewGetErrorString(glew));
+    }
+
+    glGenRenderbuffers(1, &color_buffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &depth_buffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, height);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_buffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        release();
+        throw std::runtime_error("incomplete offscreen framebuffer");
+    }
+    glViewport(0, 0, width, height);
+    gl_state::get().context_changed();
+}
+
+headless_context::~headless_context() {
+    gl_state::get().release();
+    release();
+}
+
+void headless_context::release() {
+    if (framebuffer != 0) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+    }
+    if (color_buffer != 0) glDeleteRenderbuffers(1, &color_buffer);
+    if (depth_buffer != 0) glDeleteRenderbuffers(1, &depth_buffer);
+    if (context != nullptr) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+    }
+    if (display != nullptr) eglTerminate(display);
+}
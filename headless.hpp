@@ -0,0 +1,30 @@
+#ifndef _headless_hpp_
+#define _headless_hpp_
+
+#include <GL/glew.h>
+
+// OpenGL context for machines without a display nor a GPU: an EGL
+// surfaceless context, as offered by Mesa llvmpipe, rendering into a
+// framebuffer object of the requested size. Throws std::runtime_error when
+// no such context can be created.
+class headless_context {
+public:
+    headless_context(int width, int height);
+    ~headless_context();
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+private:
+    headless_context(const headless_context&);
+    // frees whatever was created so far, for the destructor and the failures
+    // of the constructor
+    void release();
+    int width;
+    int height;
+    void* display;
+    void* context;
+    GLuint framebuffer;
+    GLuint color_buffer;
+    GLuint depth_buffer;
+};
+
+#endif
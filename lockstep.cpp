@@ -0,0 +1,357 @@
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#include "lockstep.hpp"
+
+// A message starts with the player in the high nibble and its kind in the
+// low one, then the tick. The kinds are the direction the hero takes, no
+// change, or a checksum followed by its value.
+static const uint8_t keep_kind = 0;
+static const uint8_t checksum_kind = 5;
+static const size_t input_message = 5;
+static const size_t checksum_message = 9;
+static const size_t hello_message = 10;
+
+static void write_u32(char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (char)(v >> (i * 8));
+    }
+}
+
+static uint32_t read_u32(const char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        v |= (uint32_t)(uint8_t)p[i] << (i * 8);
+    }
+    return v;
+}
+
+lockstep_session::lockstep_session(const lockstep_setup& setup) :
+    setup(setup),
+    peers(setup.player == 0 ? setup.players - 1 : 1),
+    inputs(setup.players * ring, keep_kind),
+    known(setup.players, input_delay),
+    current_tick(0),
+    pending(direction::none),
+    sent_direction(direction::none),
+    theirs(setup.players * checksum_ring, checksum{ -1, 0 }),
+    desynced(false),
+    disconnected(false),
+    bytes_sent(0),
+    bytes_received(0)
+{
+    for (auto& c : own) {
+        c.tick = -1;
+        c.value = 0;
+    }
+    for (auto& p : peers) {
+        p.size = 0;
+    }
+}
+
+std::unique_ptr<lockstep_session> lockstep_session::host(unsigned short port, unsigned seed, int size, int players) {
+    if (players < 1 || players > 15) {
+        throw std::runtime_error("lockstep: 1 to 15 players");
+    }
+    sf::TcpListener listener;
+    if (listener.listen(port) != sf::Socket::Done) {
+        throw std::runtime_error("lockstep: cannot listen on port " + std::to_string(port));
+    }
+    lockstep_setup setup = { seed, size, players, 0 };
+    std::unique_ptr<lockstep_session> session(new lockstep_session(setup));
+    for (int player = 1; player < players; player++) {
+        peer& p = session->peers[player - 1];
+        p.socket.reset(new sf::TcpSocket());
+        if (listener.accept(*p.socket) != sf::Socket::Done) {
+            throw std::runtime_error("lockstep: accepting a player failed");
+        }
+        char hello[hello_message];
+        write_u32(hello, seed);
+        write_u32(hello + 4, size);
+        hello[8] = (char) players;
+        hello[9] = (char) player;
+        if (p.socket->send(hello, hello_message) != sf::Socket::Done) {
+            throw std::runtime_error("lockstep: a player left while joining");
+        }
+        session->selector.add(*p.socket);
+    }
+    return session;
+}
+
+std::unique_ptr<lockstep_session> lockstep_session::join(const std::string& address, unsigned short port) {
+    std::unique_ptr<sf::TcpSocket> socket(new sf::TcpSocket());
+    if (socket->connect(address, port, sf::seconds(10)) != sf::Socket::Done) {
+        throw std::runtime_error("lockstep: cannot connect to " + address + ":" + std::to_string(port));
+    }
+    char hello[hello_message];
+    size_t size = 0;
+    while (size < hello_message) {
+        size_t received;
+        if (socket->receive(hello + size, hello_message - size, received) != sf::Socket::Done) {
+            throw std::runtime_error("lockstep: the host left while joining");
+        }
+        size += received;
+    }
+    lockstep_setup setup = { read_u32(hello), (int) read_u32(hello + 4), hello[8], hello[9] };
+    std::unique_ptr<lockstep_session> session(new lockstep_session(setup));
+    session->peers[0].socket = std::move(socket);
+    session->selector.add(*session->peers[0].socket);
+    return session;
+}
+
+const lockstep_setup& lockstep_session::get_setup() {
+    return setup;
+}
+
+void lockstep_session::set_direction(direction dir) {
+    pending = dir;
+}
+
+bool lockstep_session::step(game_data& game, bool wait) {
+    long tick = game.tick;
+    current_tick = tick;
+    if (known[setup.player] <= tick + input_delay) {
+        send_input(tick + input_delay);
+    }
+    receive(sf::microseconds(1));
+    while (!ready(tick)) {
+        if (!wait || disconnected) return false;
+        receive(sf::milliseconds(10));
+    }
+    for (int player = 0; player < setup.players; player++) {
+        uint8_t code = inputs[player * ring + tick % ring];
+        if (code != keep_kind) {
+            game.heroes_data[player]->next_direction = (direction) code;
+        }
+    }
+    update_game(game);
+    if (tick % checksum_interval == 0) {
+        checksum c = { tick, game_checksum(game) };
+        int slot = (tick / checksum_interval) % checksum_ring;
+        own[slot] = c;
+        for (int player = 0; player < setup.players; player++) {
+            checksum& t = theirs[player * checksum_ring + slot];
+            if (t.tick == tick && t.value != c.value) desynced = true;
+        }
+        send_checksum(c.tick, c.value);
+    }
+    return true;
+}
+
+bool lockstep_session::is_desynced() {
+    return desynced;
+}
+
+bool lockstep_session::is_disconnected() {
+    return disconnected;
+}
+
+long lockstep_session::get_bytes_sent() {
+    return bytes_sent;
+}
+
+long lockstep_session::get_bytes_received() {
+    return bytes_received;
+}
+
+void lockstep_session::send_input(long tick) {
+    uint8_t code = keep_kind;
+    if (pending != sent_direction) {
+        code = (uint8_t) pending;
+        sent_direction = pending;
+    }
+    inputs[setup.player * ring + tick % ring] = code;
+    known[setup.player] = tick + 1;
+    char message[input_message];
+    message[0] = (char)(setup.player << 4 | code);
+    write_u32(message + 1, (uint32_t) tick);
+    send(message, input_message, -1);
+}
+
+void lockstep_session::send_checksum(long tick, uint32_t value) {
+    char message[checksum_message];
+    message[0] = (char)(setup.player << 4 | checksum_kind);
+    write_u32(message + 1, (uint32_t) tick);
+    write_u32(message + 5, value);
+    send(message, checksum_message, -1);
+}
+
+// to every peer but the one it comes from
+void lockstep_session::send(const char* data, size_t size, int except) {
+    for (int i = 0; i < (int) peers.size(); i++) {
+        if (i == except) continue;
+        if (peers[i].socket->send(data, size) != sf::Socket::Done) {
+            disconnected = true;
+        } else {
+            bytes_sent += size;
+        }
+    }
+}
+
+void lockstep_session::receive(sf::Time timeout) {
+    if (!selector.wait(timeout)) return;
+    for (int i = 0; i < (int) peers.size(); i++) {
+        peer& p = peers[i];
+        if (!selector.isReady(*p.socket)) continue;
+        size_t received;
+        if (p.socket->receive(p.buffer + p.size, buffer_size - p.size, received) != sf::Socket::Done) {
+            disconnected = true;
+            continue;
+        }
+        bytes_received += received;
+        p.size += received;
+        size_t used = 0;
+        while (used < p.size) {
+            size_t length = handle(p.buffer + used, p.size - used, i);
+            if (length == 0) break;
+            used += length;
+        }
+        memmove(p.buffer, p.buffer + used, p.size - used);
+        p.size -= used;
+    }
+}
+
+// the length of the message, 0 while it is not complete. A message that
+// breaks the protocol is dropped, with the rest of the buffer, and ends the
+// session.
+size_t lockstep_session::handle(const char* data, size_t size, int from) {
+    int player = (uint8_t) data[0] >> 4;
+    uint8_t kind = data[0] & 0x0f;
+    if (kind > (uint8_t) direction::left && kind != checksum_kind) {
+        disconnected = true;
+        return size;
+    }
+    size_t length = kind == checksum_kind ? checksum_message : input_message;
+    if (size < length) return 0;
+    long tick = read_u32(data + 1);
+    if (player >= setup.players || player == setup.player) {
+        disconnected = true;
+        return size;
+    }
+    // the inputs of a player come in order, and never overwrite the slots
+    // of ticks not run yet
+    if (kind != checksum_kind && (tick < known[player] || tick >= current_tick + ring)) {
+        disconnected = true;
+        return size;
+    }
+    if (kind == checksum_kind) {
+        check(player, checksum{ tick, read_u32(data + 5) });
+    } else {
+        inputs[player * ring + tick % ring] = kind;
+        known[player] = tick + 1;
+    }
+    if (setup.player == 0) {
+        send(data, length, from);
+    }
+    return length;
+}
+
+bool lockstep_session::ready(long tick) {
+    for (long k : known) {
+        if (k <= tick) return false;
+    }
+    return true;
+}
+
+void lockstep_session::check(int player, const checksum& c) {
+    int slot = (c.tick / checksum_interval) % checksum_ring;
+    if (own[slot].tick == c.tick) {
+        if (own[slot].value != c.value) desynced = true;
+    } else {
+        theirs[player * checksum_ring + slot] = c;
+    }
+}
+
+struct local_result {
+    long tick;
+    uint32_t checksum;
+    game_outcome outcome;
+    bool desynced;
+    bool disconnected;
+    long bytes_sent;
+    long bytes_received;
+};
+
+static void run_local_player(int player, int players, int size, unsigned seed, long ticks,
+                             std::atomic<int>& finished, local_result& result) {
+    std::unique_ptr<lockstep_session> session;
+    if (player == 0) {
+        session = lockstep_session::host(lockstep_session::default_port, seed, size, players);
+    } else {
+        // the host may not be listening yet
+        for (int attempt = 0; !session; attempt++) {
+            try {
+                session = lockstep_session::join("127.0.0.1", lockstep_session::default_port);
+            } catch (std::exception&) {
+                if (attempt == 50) throw;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+    }
+    const lockstep_setup& setup = session->get_setup();
+    maze_model model(setup.size, setup.size);
+    model.create(setup.seed);
+    auto game = make_game_data(model, setup.seed, -1, setup.players);
+    // the bot's choices are inputs, outside of the game's own generator
+    rng bot(setup.player + 1);
+    while (game->tick < ticks && get_outcome(*game) == game_outcome::running &&
+           !session->is_desynced() && !session->is_disconnected()) {
+        game->arena.reset();
+        actor_data& hero = *game->heroes_data[setup.player];
+        session->set_direction(bot_direction(*game, hero, bot));
+        session->step(*game, true);
+    }
+    result.tick = game->tick;
+    result.checksum = game_checksum(*game);
+    result.outcome = get_outcome(*game);
+    result.desynced = session->is_desynced();
+    result.disconnected = session->is_disconnected();
+    result.bytes_sent = session->get_bytes_sent();
+    result.bytes_received = session->get_bytes_received();
+    // closing while the others still read would lose their last inputs
+    finished++;
+    while (finished < players) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+bool run_local_lockstep(int players, int size, long ticks) {
+    unsigned seed = (unsigned) std::rand();
+    std::vector<local_result> results(players);
+    std::atomic<int> finished(0);
+    std::vector<std::thread> threads;
+    for (int player = 0; player < players; player++) {
+        threads.push_back(std::thread([&, player]() {
+            try {
+                run_local_player(player, players, size, seed, ticks, finished, results[player]);
+            } catch (std::exception& e) {
+                std::cout << "player " << player << ": " << e.what() << std::endl;
+                results[player].disconnected = true;
+                finished++;
+            }
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    bool ok = true;
+    for (int player = 0; player < players; player++) {
+        local_result& r = results[player];
+        const char* outcomes[] = { "running", "won", "lost" };
+        std::cout << "player=" << player << " seed=" << seed << " size=" << size
+                  << " ticks=" << r.tick << " outcome=" << outcomes[(int) r.outcome]
+                  << " checksum=" << std::hex << r.checksum << std::dec
+                  << " sent=" << r.bytes_sent << " received=" << r.bytes_received
+                  << (r.desynced ? " desynced" : "") << (r.disconnected ? " disconnected" : "")
+                  << std::endl;
+        ok = ok && !r.desynced && !r.disconnected &&
+             r.tick == results[0].tick && r.checksum == results[0].checksum;
+    }
+    std::cout << (ok ? "lockstep ok" : "lockstep failed") << std::endl;
+    return ok;
+}
@@ -0,0 +1,98 @@
+#ifndef _lockstep_hpp_
+#define _lockstep_hpp_
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <SFML/Network.hpp>
+
+#include "game.hpp"
+
+// Deterministic lockstep between processes: every process runs the whole
+// game and only the tick-stamped changes of each hero's next_direction go
+// over the sockets, 5 bytes a tick and a player. The host accepts the other
+// players, gives them the maze and relays their inputs. An input is sent
+// input_delay ticks ahead of the tick it applies to, and a tick runs once
+// the inputs of all the players for it arrived.
+
+struct lockstep_setup {
+    unsigned seed;
+    int size;
+    int players;
+    // the local player, the host is 0
+    int player;
+};
+
+class lockstep_session {
+public:
+    static const unsigned short default_port = 5017;
+    static const int input_delay = 3;
+    // the state of the games is compared every so many ticks
+    static const int checksum_interval = 30;
+
+    // blocks until players - 1 peers joined
+    static std::unique_ptr<lockstep_session> host(unsigned short port, unsigned seed, int size, int players);
+    static std::unique_ptr<lockstep_session> join(const std::string& address, unsigned short port);
+
+    const lockstep_setup& get_setup();
+    // the next direction of the local hero, sent with the next tick
+    void set_direction(direction dir);
+    // runs the next tick of the game once the inputs of every player for it
+    // are known. Without wait, returns false at once when they are not.
+    bool step(game_data& game, bool wait = false);
+    bool is_desynced();
+    bool is_disconnected();
+    long get_bytes_sent();
+    long get_bytes_received();
+
+private:
+    static const int ring = 64;
+    static const int checksum_ring = 8;
+    static const int buffer_size = 256;
+
+    struct peer {
+        std::unique_ptr<sf::TcpSocket> socket;
+        char buffer[buffer_size];
+        size_t size;
+    };
+
+    struct checksum {
+        long tick;
+        uint32_t value;
+    };
+
+    lockstep_session(const lockstep_setup& setup);
+    void send_input(long tick);
+    void send_checksum(long tick, uint32_t value);
+    void send(const char* data, size_t size, int except);
+    void receive(sf::Time timeout);
+    size_t handle(const char* data, size_t size, int from);
+    bool ready(long tick);
+    void check(int player, const checksum& theirs);
+
+    lockstep_setup setup;
+    std::vector<peer> peers;
+    sf::SocketSelector selector;
+    // the input codes of each player, by tick modulo the ring
+    std::vector<uint8_t> inputs;
+    // the inputs of a player are known up to this tick, excluded
+    std::vector<long> known;
+    // the tick being stepped, the inputs received must fit in the ring after it
+    long current_tick;
+    direction pending;
+    direction sent_direction;
+    checksum own[checksum_ring];
+    // the checksums of the other players not compared yet
+    std::vector<checksum> theirs;
+    bool desynced;
+    bool disconnected;
+    long bytes_sent;
+    long bytes_received;
+};
+
+// plays players bots against each other over loopback, a thread each, and
+// checks that all the games stay the same
+bool run_local_lockstep(int players, int size, long ticks);
+
+#endif
@@ -1,59 +1,84 @@
-#ifndef _matrix_hpp_
-#define _matrix_hpp_
-
-struct vector3 {
-    vector3();
-    vector3(float x, float y, float z);
-    float v[3];
-    float x() const;
-    float y() const;
-    float z() const;
-};
-
-vector3 operator+(const vector3& v1, const vector3& v2);
-
-vector3 operator-(const vector3& v1, const vector3& v2);
-
-vector3 operator*(const vector3& v, float t);
-
-struct vector4 {
-    vector4(float x, float y, float z, float w);
-    vector4(const vector3 vec3, float w);
-    float v[4];
-};
-
-struct color : vector4 {
-    color();
-    color(float r, float g, float b, float a = 1.0f);
-    float r() const;
-    float g() const;
-    float b() const;
-    float a() const;
-};
-
-vector3 normalize(vector3 v);
-
-vector3 cross_product(const vector3& u, const vector3& v);
-
-struct matrix44
-{
-    float m[16];
-};
-
-matrix44 multm(matrix44 m1, matrix44 m2);
-
-matrix44 identity();
-
-matrix44 frustum(float left, float right, float bottom, float top, float nearp, float farp);
-
-matrix44 ortho(float left, float right, float bottom, float top, float nearp, float farp);
-
-matrix44 translation(float x, float y, float z);
-
-float to_radians(float a);
-
-matrix44 rotation(float a, float x, float y, float z);
-
-matrix44 look_at(float eyeX, float eyeY, float eyeZ, float centerX, float centerY, float centerZ, float upX, float upY, float upZ);
-
-#endif
+#ifndef _matrix_hpp_
+#define _matrix_hpp_
+
+#include <math.h>
+#include <stddef.h>
+
+// The 4x4 products use SSE when the target has it, unless AMAZING_NO_SIMD
+// is defined. Both paths do the same operations in the same order, so they
+// give identical results.
+#if !defined(AMAZING_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define AMAZING_SIMD_SSE 1
+#endif
+
+struct vector3 {
+    vector3() { v[0] = 0; v[1] = 0; v[2] = 0; }
+    vector3(float x, float y, float z) { v[0] = x; v[1] = y; v[2] = z; }
+    float v[3];
+    float x() const { return v[0]; }
+    float y() const { return v[1]; }
+    float z() const { return v[2]; }
+};
+
+inline vector3 operator+(const vector3& v1, const vector3& v2) {
+    return vector3(v1.v[0] + v2.v[0], v1.v[1] + v2.v[1], v1.v[2] + v2.v[2]);
+}
+
+inline vector3 operator-(const vector3& v1, const vector3& v2) {
+    return vector3(v1.v[0] - v2.v[0], v1.v[1] - v2.v[1], v1.v[2] - v2.v[2]);
+}
+
+inline vector3 operator*(const vector3& v, float t) {
+    return vector3(t*v.v[0], t*v.v[1], t*v.v[2]);
+}
+
+struct vector4 {
+    vector4(float x, float y, float z, float w);
+    vector4(const vector3 vec3, float w);
+    float v[4];
+};
+
+struct color : vector4 {
+    color();
+    color(float r, float g, float b, float a = 1.0f);
+    float r() const;
+    float g() const;
+    float b() const;
+    float a() const;
+};
+
+inline vector3 normalize(const vector3& v) {
+    float norm = sqrt(v.v[0] * v.v[0] + v.v[1] * v.v[1] + v.v[2] * v.v[2]);
+    return vector3(v.v[0] / norm, v.v[1] / norm, v.v[2] / norm);
+}
+
+inline vector3 cross_product(const vector3& u, const vector3& v) {
+    return vector3(u.y()*v.z() - u.z()*v.y(), u.z()*v.x() - u.x()*v.z(), u.x()*v.y() - u.y()*v.x());
+}
+
+// column major, like OpenGL
+struct alignas(16) matrix44
+{
+    float m[16];
+};
+
+matrix44 multm(const matrix44& m1, const matrix44& m2);
+
+// out[i] = m1 * m2[i] for i in [0, n), out may be m2
+void multm(const matrix44& m1, const matrix44* m2, matrix44* out, size_t n);
+
+matrix44 identity();
+
+matrix44 frustum(float left, float right, float bottom, float top, float nearp, float farp);
+
+matrix44 ortho(float left, float right, float bottom, float top, float nearp, float farp);
+
+matrix44 translation(float x, float y, float z);
+
+float to_radians(float a);
+
+matrix44 rotation(float a, float x, float y, float z);
+
+matrix44 look_at(float eyeX, float eyeY, float eyeZ, float centerX, float centerY, float centerZ, float upX, float upY, float upZ);
+
+#endif
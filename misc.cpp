@@ -1,15 +1,43 @@
-#include <iostream>
-#include <GL/glew.h>
-
-#include "misc.hpp"
-
-void check_for_opengl_errors() {
-    switch (glGetError()) {
-    case GL_INVALID_ENUM: std::cout << "GLenum argument out of range" << std::endl; break;
-    case GL_INVALID_VALUE: std::cout << "Numeric argument out of range" << std::endl; break;
-    case GL_INVALID_OPERATION: std::cout << "Operation illegal in current state" << std::endl; break;
-    case GL_STACK_OVERFLOW: std::cout << "Command would cause a stack overflow" << std::endl; break;
-    case GL_STACK_UNDERFLOW: std::cout << "Command would cause a stack underflow" << std::endl; break;
-    case GL_OUT_OF_MEMORY: std::cout << "Not enough memory left to execute command" << std::endl; break;
-    }
-}
+#include <iostream>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <GL/glew.h>
+
+#include "misc.hpp"
+
+void check_for_opengl_errors() {
+    switch (glGetError()) {
+    case GL_INVALID_ENUM: std::cout << "GLenum argument out of range" << std::endl; break;
+    case GL_INVALID_VALUE: std::cout << "Numeric argument out of range" << std::endl; break;
+    case GL_INVALID_OPERATION: std::cout << "Operation illegal in current state" << std::endl; break;
+    case GL_STACK_OVERFLOW: std::cout << "Command would cause a stack overflow" << std::endl; break;
+    case GL_STACK_UNDERFLOW: std::cout << "Command would cause a stack underflow" << std::endl; break;
+    case GL_OUT_OF_MEMORY: std::cout << "Not enough memory left to execute command" << std::endl; break;
+    }
+}
+
+bool parse_long(const char* text, long& value) {
+    char* end;
+    errno = 0;
+    long v = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE) return false;
+    value = v;
+    return true;
+}
+
+bool parse_int(const char* text, int& value) {
+    long v;
+    if (!parse_long(text, v) || v < INT_MIN || v > INT_MAX) return false;
+    value = (int) v;
+    return true;
+}
+
+bool parse_double(const char* text, double& value) {
+    char* end;
+    errno = 0;
+    double v = strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE) return false;
+    value = v;
+    return true;
+}
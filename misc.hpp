@@ -1,6 +1,12 @@
-#ifndef _misc_hpp_
-#define _misc_hpp_
-
-void check_for_opengl_errors();
-
+#ifndef _misc_hpp_
+#define _misc_hpp_
+
+void check_for_opengl_errors();
+
+// the whole of text as a number of the type, false on anything else or when
+// it does not fit, for the values of command line options
+bool parse_long(const char* text, long& value);
+bool parse_int(const char* text, int& value);
+bool parse_double(const char* text, double& value);
+
 #endif
\ No newline at end of file
@@ -1,189 +1,362 @@
-#include <iostream>
-#include <ctime>
-#include <cstdlib>
-#include <algorithm>
-#include <chrono>
-#include <random>
-#include <stdexcept>
-
-#include "amazing.hpp"
-
-bool cell::comp::operator() (const cell& c1, const cell& c2) const {
-	if (c1.x < c2.x) {
-		return true;
-	} else if (c1.x == c2.x)
-		return c1.y < c2.y;
-	else {
-		return false;
-	}
-}
-
-maze_model::maze_model(int width_, int height_) :
-    width(width_), height(height_), cells(width*height, cell())
-{
-	for (int i = 0; i < width; i++) {
-		for (int j = 0; j < height; j++) {
-			get_cell(i,j).x = i;
-			get_cell(i,j).y = j;
-			get_cell(i,j).wall = true;
-		}
-	}
-}
-
-void maze_model::create() {
-    std::set<cell, cell::comp> visited;
-    int count = 0;
-    visit(get_cell(1,1), visited, count);
-    get_cell(0, 1).wall = false;
-    get_cell(width-1, height-2).wall = false;
-}
-
-int maze_model::get_width() {
-    return width;
-}
-
-int maze_model::get_height() {
-    return height;
-}
-
-pos maze_model::find_empty_cell(int line, int col) {
-    for (int y = line - 1; y <= line + 1; y++) {
-        for (int x = col - 1; x <= col + 1; x++) {
-            if (!get_cell(col, y).wall) {
-                return pos{ col, y };
-            }
-        }
-    }
-    throw std::exception();
-}
-
-void maze_model::visit(cell& c, std::set<cell, cell::comp>& visited, int& count) {
-	c.wall = false;
-    visited.insert(c);
-    std::vector<cell*> neighbors;
-	if ((c.x > 2) && !contains(get_cell(c.x-2, c.y), visited)) neighbors.push_back(&get_cell(c.x-2, c.y));
-	if ((c.x < width-2) && !contains(get_cell(c.x+2, c.y), visited)) neighbors.push_back(&get_cell(c.x+2, c.y));
-	if ((c.y > 2) && !contains(get_cell(c.x, c.y-2), visited)) neighbors.push_back(&get_cell(c.x, c.y-2));
-	if ((c.y < height-2) && !contains(get_cell(c.x, c.y+2), visited)) neighbors.push_back(&get_cell(c.x, c.y+2));
-	std::random_shuffle(neighbors.begin(), neighbors.end());
-    for (auto& n : neighbors) {
-		if ((visited.find(*n) != visited.end()) && (count % 11 != 0)) {
-            continue;
-        }
-		int wx = (n->x + c.x) / 2;
-		int wy = (n->y + c.y) / 2;
-		get_cell(wx, wy).wall = false;
-        visit(*n, visited, count);
-        count++;
-    }
-}
-
-maze_geometry_builder_2d ::maze_geometry_builder_2d(maze_model& model_) : model(model_) {}
-
-std::shared_ptr<geometry<float>> maze_geometry_builder_2d::build() {
-    std::vector<float> v;
-    for (auto& cell : model.get_cells()) {
-        if (cell.wall) {
-            v.push_back(cell.x+0.0f); v.push_back(cell.y+0.0f);
-            v.push_back(cell.x+1.0f); v.push_back(cell.y+0.0f);
-            v.push_back(cell.x+1.0f); v.push_back(cell.y+1.0f);
-            v.push_back(cell.x+0.0f); v.push_back(cell.y+1.0f);
-        }
-    }
-    auto mazeGeom = std::make_shared<geometry<float>>(geometry<float>(v.size()/2));
-    mazeGeom->set_vertex_positions(&v[0], v.size() * sizeof(float));
-    return mazeGeom;
-}
-
-maze_geometry_builder_3d ::maze_geometry_builder_3d(maze_model& model_) : model(model_) {}
-
-std::shared_ptr<geometry<float>> maze_geometry_builder_3d::build() {
-    buffer_object_builder<float> posb;
-    buffer_object_builder<float> norb;
-    for (auto& cell : model.get_cells()) {
-        if (cell.wall) {
-            // top
-            posb << cell.x + 0.0f << cell.y + 0.0f << 1.0f;
-            posb << cell.x + 1.0f << cell.y + 0.0f << 1.0f;
-            posb << cell.x + 1.0f << cell.y + 1.0f << 1.0f;
-            posb << cell.x + 0.0f << cell.y + 1.0f << 1.0f;
-            for (int i = 0; i < 4; i++) norb << 0.0f << 0.0f << 1.0f;
-            // bottom
-            posb << cell.x + 0.0f << cell.y + 0.0f << 0.0f;
-            posb << cell.x + 0.0f << cell.y + 1.0f << 0.0f;
-            posb << cell.x + 1.0f << cell.y + 1.0f << 0.0f;
-            posb << cell.x + 1.0f << cell.y + 0.0f << 0.0f;
-            for (int i = 0; i < 4; i++) norb << 0.0f << 0.0f << -1.0f;
-            // right
-            posb << cell.x + 1.0f << cell.y + 0.0f << 1.0f;
-            posb << cell.x + 1.0f << cell.y + 0.0f << 0.0f;
-            posb << cell.x + 1.0f << cell.y + 1.0f << 0.0f;
-            posb << cell.x + 1.0f << cell.y + 1.0f << 1.0f;
-            for (int i = 0; i < 4; i++) norb << 1.0f << 0.0f << 0.0f;
-            // left
-            posb << cell.x + 0.0f << cell.y + 0.0f << 1.0f;
-            posb << cell.x + 0.0f << cell.y + 1.0f << 1.0f;
-            posb << cell.x + 0.0f << cell.y + 1.0f << 0.0f;
-            posb << cell.x + 0.0f << cell.y + 0.0f << 0.0f;
-            for (int i = 0; i < 4; i++) norb << -1.0f << 0.0f << 0.0f;
-            // front
-            posb << cell.x + 0.0f << cell.y + 0.0f << 1.0f;
-            posb << cell.x + 0.0f << cell.y + 0.0f << 0.0f;
-            posb << cell.x + 1.0f << cell.y + 0.0f << 0.0f;
-            posb << cell.x + 1.0f << cell.y + 0.0f << 1.0f;
-            for (int i = 0; i < 4; i++) norb << 0.0f << -1.0f << 0.0f;
-            // back
-            posb << cell.x + 0.0f << cell.y + 1.0f << 1.0f;
-            posb << cell.x + 1.0f << cell.y + 1.0f << 1.0f;
-            posb << cell.x + 1.0f << cell.y + 1.0f << 0.0f;
-            posb << cell.x + 0.0f << cell.y + 1.0f << 0.0f;
-            for (int i = 0; i < 4; i++) norb << 0.0f << 1.0f << 0.0f;
-        }
-    }
-    auto mazeGeom = std::make_shared<geometry<float>>(geometry<float>(posb.get_count()/3));
-    mazeGeom->set_vertex_positions(posb.build());
-    mazeGeom->set_vertex_normals(norb.build());
-    return mazeGeom;
-}
-
-hero_builder_2d::hero_builder_2d() {}
-
-std::shared_ptr<geometry<float>> hero_builder_2d::build() {
-    buffer_object_builder<float> b;
-    b << 0.0f << 0.0f;
-    b << 1.0f << 0.0f;
-    b << 1.0f << 1.0f;
-    b << 0.0f << 1.0f;
-    auto hero = std::make_shared<geometry<float>>(geometry<float>(b.get_size() / 2));
-    hero->set_vertex_positions(b.build());
-    hero->set_vertex_tex_coords(b.build());
-    return hero;
-}
-
-multi_hero_builder_2d::multi_hero_builder_2d() {}
-
-std::shared_ptr<geometry<float>> multi_hero_builder_2d::build() {
-    buffer_object_builder<float> b;
-    b << -50.0f << -50.0f;
-    b << 50.0f << -50.0f;
-    b << 50.0f << 50.0f;
-    b << -50.0f << 50.0f;
-    auto multi_hero = std::make_shared<geometry<float>>(geometry<float>(b.get_size() / 2));
-    multi_hero->set_vertex_positions(b.build());
-    multi_hero->set_vertex_tex_coords(b.build());
-    return multi_hero;
-}
-
-bad_guy_builder_2d::bad_guy_builder_2d() {}
-
-std::shared_ptr<geometry<float>> bad_guy_builder_2d::build() {
-    buffer_object_builder<float> b;
-    b << 0.0f << 0.0f;
-    b << 1.0f << 0.0f;
-    b << 1.0f << 1.0f;
-    b << 0.0f << 1.0f;
-    auto bad_guy = std::make_shared<geometry<float>>(geometry<float>(b.get_size() / 2));
-    bad_guy->set_vertex_positions(b.build());
-    bad_guy->set_vertex_tex_coords(b.build());
-    return bad_guy;
-}
+#include <iostream>
+#include <ctime>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <functional>
+#include <thread>
+
+#include "amazing.hpp"
+
+bool cell::comp::operator() (const cell& c1, const cell& c2) const {
+	if (c1.x < c2.x) {
+		return true;
+	} else if (c1.x == c2.x)
+		return c1.y < c2.y;
+	else {
+		return false;
+	}
+}
+
+maze_model::maze_model(int width_, int height_) :
+    width(width_), height(height_), cells(width*height, cell()), seed(0)
+{
+	for (int i = 0; i < width; i++) {
+		for (int j = 0; j < height; j++) {
+			get_cell(i,j).x = i;
+			get_cell(i,j).y = j;
+			get_cell(i,j).wall = true;
+		}
+	}
+}
+
+void maze_model::create(unsigned seed_) {
+    seed = seed_;
+    rng random(seed);
+    std::set<cell, cell::comp> visited;
+    int count = 0;
+    visit(get_cell(1,1), visited, count, random);
+    get_cell(0, 1).wall = false;
+    get_cell(width-1, height-2).wall = false;
+}
+
+void maze_model::create() {
+    create((unsigned)std::rand());
+}
+
+unsigned maze_model::get_seed() {
+    return seed;
+}
+
+int maze_model::get_width() {
+    return width;
+}
+
+int maze_model::get_height() {
+    return height;
+}
+
+pos maze_model::find_empty_cell(int line, int col) {
+    for (int y = line - 1; y <= line + 1; y++) {
+        for (int x = col - 1; x <= col + 1; x++) {
+            if (!get_cell(col, y).wall) {
+                return pos{ col, y };
+            }
+        }
+    }
+    throw std::exception();
+}
+
+void maze_model::visit(cell& c, std::set<cell, cell::comp>& visited, int& count, rng& random) {
+	c.wall = false;
+    visited.insert(c);
+    std::vector<cell*> neighbors;
+	if ((c.x > 2) && !contains(get_cell(c.x-2, c.y), visited)) neighbors.push_back(&get_cell(c.x-2, c.y));
+	if ((c.x < width-2) && !contains(get_cell(c.x+2, c.y), visited)) neighbors.push_back(&get_cell(c.x+2, c.y));
+	if ((c.y > 2) && !contains(get_cell(c.x, c.y-2), visited)) neighbors.push_back(&get_cell(c.x, c.y-2));
+	if ((c.y < height-2) && !contains(get_cell(c.x, c.y+2), visited)) neighbors.push_back(&get_cell(c.x, c.y+2));
+    for (int i = (int)neighbors.size() - 1; i > 0; i--) {
+        std::swap(neighbors[i], neighbors[random.below(i + 1)]);
+    }
+    for (auto& n : neighbors) {
+		if ((visited.find(*n) != visited.end()) && (count % 11 != 0)) {
+            continue;
+        }
+		int wx = (n->x + c.x) / 2;
+		int wy = (n->y + c.y) / 2;
+		get_cell(wx, wy).wall = false;
+        visit(*n, visited, count, random);
+        count++;
+    }
+}
+
+// writes the vertices of a wall in preallocated memory
+struct float_writer {
+    float* p;
+    float_writer& operator<<(float f) {
+        *p++ = f;
+        return *this;
+    }
+};
+
+// runs f(0) .. f(n - 1) concurrently, f(0) on the calling thread
+static void run_workers(int n, const std::function<void(int)>& f) {
+    std::vector<std::thread> threads;
+    for (int i = 1; i < n; i++) {
+        threads.push_back(std::thread(f, i));
+    }
+    f(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+static const int min_rows_per_worker = 16;
+
+// The vertices of the walls the cells kept by keep_wall, in the order of the
+// cells. Each worker takes a block of rows: the walls of every block are
+// counted first so that the output is allocated once, then each block writes
+// its own range.
+template <class K, class W>
+static std::vector<float> generate_walls(maze_model& model, size_t floats_per_wall, K keep_wall, W write_wall) {
+    int width = model.get_width();
+    int height = model.get_height();
+    int hardware = std::max(1, (int) std::thread::hardware_concurrency());
+    int workers = std::max(1, std::min(hardware, height / min_rows_per_worker));
+    std::vector<size_t> offsets(workers + 1, 0);
+    run_workers(workers, [&](int w) {
+        size_t walls = 0;
+        for (int y = height * w / workers; y < height * (w + 1) / workers; y++) {
+            for (int x = 0; x < width; x++) {
+                if (keep_wall(model.get_cell(x, y))) walls++;
+            }
+        }
+        offsets[w + 1] = walls;
+    });
+    for (int w = 0; w < workers; w++) {
+        offsets[w + 1] += offsets[w];
+    }
+    std::vector<float> v(offsets[workers] * floats_per_wall);
+    run_workers(workers, [&](int w) {
+        float_writer b = { v.data() + offsets[w] * floats_per_wall };
+        for (int y = height * w / workers; y < height * (w + 1) / workers; y++) {
+            for (int x = 0; x < width; x++) {
+                const cell& c = model.get_cell(x, y);
+                if (keep_wall(c)) write_wall(c, b);
+            }
+        }
+    });
+    return v;
+}
+
+// every wall of the maze
+template <class W>
+static std::vector<float> generate_walls(maze_model& model, size_t floats_per_wall, W write_wall) {
+    return generate_walls(model, floats_per_wall, [](const cell& c) { return c.wall; }, write_wall);
+}
+
+static const int wall_floats_2d = 8;
+
+static void write_wall_2d(const cell& cell, float_writer& b) {
+    b << cell.x + 0.0f << cell.y + 0.0f;
+    b << cell.x + 1.0f << cell.y + 0.0f;
+    b << cell.x + 1.0f << cell.y + 1.0f;
+    b << cell.x + 0.0f << cell.y + 1.0f;
+}
+
+maze_geometry_builder_2d ::maze_geometry_builder_2d(maze_model& model_) : model(model_) {}
+
+vertex_layout maze_geometry_builder_2d::layout() {
+    vertex_layout layout;
+    layout.add(vertex_attribute::POSITION, 2);
+    return layout;
+}
+
+std::vector<float> maze_geometry_builder_2d::generate() {
+    return generate_walls(model, wall_floats_2d, write_wall_2d);
+}
+
+std::shared_ptr<geometry<float>> maze_geometry_builder_2d::build() {
+    std::vector<float> v = generate();
+    auto mazeGeom = std::make_shared<geometry<float>>(v.size() / layout().stride);
+    mazeGeom->set_vertices(v.data(), v.size() * sizeof(float), layout());
+    return mazeGeom;
+}
+
+static const int cell_vertices_2d = 4;
+
+mutable_maze_geometry_2d::mutable_maze_geometry_2d(maze_model& model_, const std::vector<pos>& changeable_) :
+    model(model_), changeable(changeable_), slots(model_.get_cells().size(), -1), first_slot(0)
+{
+    for (size_t i = 0; i < changeable.size(); i++) {
+        slots[changeable[i].x + changeable[i].y * model.get_width()] = (int) i;
+    }
+    std::vector<float> v = generate();
+    vertex_layout layout;
+    layout.add(vertex_attribute::POSITION, 2);
+    geom = std::make_shared<geometry<float>>(v.size() / 2);
+    geom->set_vertices(v.data(), v.size() * sizeof(float), layout, GL_DYNAMIC_DRAW);
+}
+
+std::vector<float> mutable_maze_geometry_2d::generate() {
+    std::vector<float> v = generate_walls(model, wall_floats_2d, [this](const cell& c) {
+        return c.wall && slots[c.x + c.y * model.get_width()] < 0;
+    }, write_wall_2d);
+    size_t walls = v.size();
+    first_slot = (GLsizei) (walls / 2);
+    v.resize(walls + changeable.size() * wall_floats_2d);
+    for (size_t i = 0; i < changeable.size(); i++) {
+        write_cell(model.get_cell(changeable[i]), &v[walls + i * wall_floats_2d]);
+    }
+    return v;
+}
+
+void mutable_maze_geometry_2d::update_cell(int x, int y) {
+    int slot = slots[x + y * model.get_width()];
+    if (slot < 0) {
+        rebuild();
+        return;
+    }
+    float v[wall_floats_2d];
+    write_cell(model.get_cell(x, y), v);
+    vertex_range range = { first_slot + slot * cell_vertices_2d, cell_vertices_2d };
+    geom->update_vertices(range, v);
+}
+
+void mutable_maze_geometry_2d::rebuild() {
+    std::vector<float> v = generate();
+    geom->reset_vertices(v.data(), v.size() * sizeof(float), (GLsizei) (v.size() / 2));
+}
+
+void mutable_maze_geometry_2d::write_cell(const cell& c, float* v) {
+    float size = c.wall ? 1.0f : 0.0f;
+    v[0] = c.x + 0.0f; v[1] = c.y + 0.0f;
+    v[2] = c.x + size; v[3] = c.y + 0.0f;
+    v[4] = c.x + size; v[5] = c.y + size;
+    v[6] = c.x + 0.0f; v[7] = c.y + size;
+}
+
+maze_grid_2d::maze_grid_2d(maze_model& model_) : model(model_) {
+    int w = model.get_width();
+    int h = model.get_height();
+    std::vector<GLubyte> cells = generate();
+    grid = std::make_shared<grid_texture>(&cells[0], w, h);
+    float v[] = { 0.0f, 0.0f, (float) w, 0.0f, (float) w, (float) h, 0.0f, (float) h };
+    vertex_layout layout;
+    layout.add(vertex_attribute::POSITION, 2);
+    quad = std::make_shared<geometry<float>>(4);
+    quad->set_vertices(v, sizeof(v), layout);
+}
+
+void maze_grid_2d::update_cell(int x, int y) {
+    GLubyte texel = model.get_cell(x, y).wall ? 255 : 0;
+    grid->update(x, y, 1, 1, &texel);
+}
+
+void maze_grid_2d::rebuild() {
+    std::vector<GLubyte> cells = generate();
+    grid->update(0, 0, model.get_width(), model.get_height(), &cells[0]);
+}
+
+std::vector<GLubyte> maze_grid_2d::generate() {
+    int w = model.get_width();
+    std::vector<GLubyte> cells(model.get_cells().size());
+    for (auto& cell : model.get_cells()) {
+        cells[cell.x + cell.y * w] = cell.wall ? 255 : 0;
+    }
+    return cells;
+}
+
+maze_geometry_builder_3d ::maze_geometry_builder_3d(maze_model& model_) : model(model_) {}
+
+vertex_layout maze_geometry_builder_3d::layout() {
+    // interleaved position (x, y, z) and normal (nx, ny, nz)
+    vertex_layout layout;
+    layout.add(vertex_attribute::POSITION, 3).add(vertex_attribute::NORMAL, 3);
+    return layout;
+}
+
+std::vector<float> maze_geometry_builder_3d::generate() {
+    // six faces of four vertices
+    return generate_walls(model, 6 * 4 * 6, [](const cell& cell, float_writer& b) {
+        // top
+        b << cell.x + 0.0f << cell.y + 0.0f << 1.0f << 0.0f << 0.0f << 1.0f;
+        b << cell.x + 1.0f << cell.y + 0.0f << 1.0f << 0.0f << 0.0f << 1.0f;
+        b << cell.x + 1.0f << cell.y + 1.0f << 1.0f << 0.0f << 0.0f << 1.0f;
+        b << cell.x + 0.0f << cell.y + 1.0f << 1.0f << 0.0f << 0.0f << 1.0f;
+        // bottom
+        b << cell.x + 0.0f << cell.y + 0.0f << 0.0f << 0.0f << 0.0f << -1.0f;
+        b << cell.x + 0.0f << cell.y + 1.0f << 0.0f << 0.0f << 0.0f << -1.0f;
+        b << cell.x + 1.0f << cell.y + 1.0f << 0.0f << 0.0f << 0.0f << -1.0f;
+        b << cell.x + 1.0f << cell.y + 0.0f << 0.0f << 0.0f << 0.0f << -1.0f;
+        // right
+        b << cell.x + 1.0f << cell.y + 0.0f << 1.0f << 1.0f << 0.0f << 0.0f;
+        b << cell.x + 1.0f << cell.y + 0.0f << 0.0f << 1.0f << 0.0f << 0.0f;
+        b << cell.x + 1.0f << cell.y + 1.0f << 0.0f << 1.0f << 0.0f << 0.0f;
+        b << cell.x + 1.0f << cell.y + 1.0f << 1.0f << 1.0f << 0.0f << 0.0f;
+        // left
+        b << cell.x + 0.0f << cell.y + 0.0f << 1.0f << -1.0f << 0.0f << 0.0f;
+        b << cell.x + 0.0f << cell.y + 1.0f << 1.0f << -1.0f << 0.0f << 0.0f;
+        b << cell.x + 0.0f << cell.y + 1.0f << 0.0f << -1.0f << 0.0f << 0.0f;
+        b << cell.x + 0.0f << cell.y + 0.0f << 0.0f << -1.0f << 0.0f << 0.0f;
+        // front
+        b << cell.x + 0.0f << cell.y + 0.0f << 1.0f << 0.0f << -1.0f << 0.0f;
+        b << cell.x + 0.0f << cell.y + 0.0f << 0.0f << 0.0f << -1.0f << 0.0f;
+        b << cell.x + 1.0f << cell.y + 0.0f << 0.0f << 0.0f << -1.0f << 0.0f;
+        b << cell.x + 1.0f << cell.y + 0.0f << 1.0f << 0.0f << -1.0f << 0.0f;
+        // back
+        b << cell.x + 0.0f << cell.y + 1.0f << 1.0f << 0.0f << 1.0f << 0.0f;
+        b << cell.x + 1.0f << cell.y + 1.0f << 1.0f << 0.0f << 1.0f << 0.0f;
+        b << cell.x + 1.0f << cell.y + 1.0f << 0.0f << 0.0f << 1.0f << 0.0f;
+        b << cell.x + 0.0f << cell.y + 1.0f << 0.0f << 0.0f << 1.0f << 0.0f;
+    });
+}
+
+std::shared_ptr<geometry<float>> maze_geometry_builder_3d::build() {
+    std::vector<float> v = generate();
+    auto mazeGeom = std::make_shared<geometry<float>>(v.size() / layout().stride);
+    mazeGeom->set_vertices(v.data(), v.size() * sizeof(float), layout());
+    return mazeGeom;
+}
+
+// The actor quads interleave position (x, y) and texture coordinates (u, v).
+static vertex_layout quad_layout() {
+    vertex_layout layout;
+    layout.add(vertex_attribute::POSITION, 2).add(vertex_attribute::TEXCOORD, 2);
+    return layout;
+}
+
+actor_builder_2d::actor_builder_2d() {}
+
+std::shared_ptr<geometry<float>> actor_builder_2d::build() {
+    buffer_object_builder<float> b;
+    b << 0.0f << 0.0f << 0.0f << 0.0f;
+    b << 1.0f << 0.0f << 1.0f << 0.0f;
+    b << 1.0f << 1.0f << 1.0f << 1.0f;
+    b << 0.0f << 1.0f << 0.0f << 1.0f;
+    auto actor = std::make_shared<geometry<float>>(b.get_count() / 4);
+    actor->set_vertices(b.get_data(), b.get_size(), quad_layout());
+    return actor;
+}
+
+// Each actor instance is its position (x, y) and a sprite selector.
+vertex_layout actor_instance_layout() {
+    vertex_layout layout;
+    layout.add(vertex_attribute::INSTANCE, 3);
+    return layout;
+}
+
+multi_hero_builder_2d::multi_hero_builder_2d() {}
+
+std::shared_ptr<geometry<float>> multi_hero_builder_2d::build() {
+    buffer_object_builder<float> b;
+    b << -50.0f << -50.0f << -50.0f << -50.0f;
+    b << 50.0f << -50.0f << 50.0f << -50.0f;
+    b << 50.0f << 50.0f << 50.0f << 50.0f;
+    b << -50.0f << 50.0f << -50.0f << 50.0f;
+    auto multi_hero = std::make_shared<geometry<float>>(b.get_count() / 4);
+    multi_hero->set_vertices(b.get_data(), b.get_size(), quad_layout());
+    return multi_hero;
+}
@@ -1,9 +1,9 @@
-#version 330
-
-in vec4 vcolor;
-
-out vec4 fcolor;
-
-void main(void) {
-	fcolor = vcolor;
+#version 330
+
+in vec4 vcolor;
+
+out vec4 fcolor;
+
+void main(void) {
+	fcolor = vcolor;
 }
\ No newline at end of file
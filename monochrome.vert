@@ -1,13 +1,14 @@
-#version 330
-
-uniform mat4 mvpMatrix;
-uniform vec4 color;
-
-in vec2 vpos;
-
-out vec4 vcolor;
-
-void main(void) {
-	gl_Position = mvpMatrix * vec4(vpos, 0.0f, 1.0f);
-	vcolor = color;
-}
+#version 330
+
+// one matrix per copy of an instanced draw, the first one otherwise
+uniform mat4 mvpMatrices[16];
+uniform vec4 color;
+
+in vec2 vpos;
+
+out vec4 vcolor;
+
+void main(void) {
+	gl_Position = mvpMatrices[gl_InstanceID] * vec4(vpos, 0.0f, 1.0f);
+	vcolor = color;
+}
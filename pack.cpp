@@ -0,0 +1,107 @@
+// Build tool: packs the assets into one archive read by archive.cpp.
+//   amazing_pack <output.pak> [-c <output.cpp>] <files...>
+// With -c the archive is also written as a C++ array to link in the game.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct entry {
+    std::string name;
+    std::string data;
+    uint64_t offset;
+};
+
+static void write_le(std::string& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back((char) (v & 0xff));
+        v >>= 8;
+    }
+}
+
+static std::string base_name(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static bool write_source(const std::string& filename, const std::string& pak) {
+    std::ofstream out(filename);
+    out << "// generated by amazing_pack, do not edit\n";
+    out << "#include <cstddef>\n\n";
+    out << "extern const unsigned char amazing_embedded_archive[];\n";
+    out << "extern const size_t amazing_embedded_archive_size;\n\n";
+    out << "alignas(16) const unsigned char amazing_embedded_archive[] = {";
+    static const char* hex = "0123456789abcdef";
+    for (size_t i = 0; i < pak.size(); i++) {
+        unsigned char c = pak[i];
+        out << (i % 16 == 0 ? "\n    " : " ") << "0x" << hex[c >> 4] << hex[c & 15] << ",";
+    }
+    out << "\n};\n\n";
+    out << "const size_t amazing_embedded_archive_size = " << pak.size() << ";\n";
+    return (bool) out;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "usage: amazing_pack <output.pak> [-c <output.cpp>] <files...>" << std::endl;
+        return -1;
+    }
+    std::string pak_name = argv[1];
+    std::string source_name;
+    std::vector<entry> entries;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-c" && i + 1 < argc) {
+            source_name = argv[++i];
+            continue;
+        }
+        std::ifstream f(arg, std::ios::binary);
+        if (!f) {
+            std::cout << "Failed to read " << arg << std::endl;
+            return -1;
+        }
+        std::stringstream buffer;
+        buffer << f.rdbuf();
+        entry e = {base_name(arg), buffer.str(), 0};
+        entries.push_back(e);
+    }
+
+    size_t index_size = 12;
+    for (auto& e : entries) {
+        index_size += 4 + e.name.size() + 16;
+    }
+    uint64_t offset = index_size;
+    for (auto& e : entries) {
+        offset = (offset + 15) & ~uint64_t(15);
+        e.offset = offset;
+        offset += e.data.size();
+    }
+
+    std::string pak("AMZPAK01");
+    write_le(pak, entries.size(), 4);
+    for (auto& e : entries) {
+        write_le(pak, e.name.size(), 4);
+        pak += e.name;
+        write_le(pak, e.offset, 8);
+        write_le(pak, e.data.size(), 8);
+    }
+    for (auto& e : entries) {
+        pak.resize(e.offset, '\0');
+        pak += e.data;
+    }
+
+    std::ofstream out(pak_name, std::ios::binary);
+    out.write(pak.data(), pak.size());
+    if (!out) {
+        std::cout << "Failed to write " << pak_name << std::endl;
+        return -1;
+    }
+    if (!source_name.empty() && !write_source(source_name, pak)) {
+        std::cout << "Failed to write " << source_name << std::endl;
+        return -1;
+    }
+    return 0;
+}
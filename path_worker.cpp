@@ -0,0 +1,139 @@
+#include <memory>
+#include <algorithm>
+
+#include "path_worker.hpp"
+
+path_worker::path_worker(game_data& game) :
+    model(game.model),
+    view(model, 0),
+    requested(false),
+    walls_changed(false),
+    published(0),
+    stopping(false)
+{
+    view.arena.reserve(model.get_width() * model.get_height() * sizeof(int) + 4096);
+    for (auto& r : results) {
+        r.tick = -1;
+    }
+    pending.tick = -1;
+    thread = std::thread(&path_worker::run, this);
+}
+
+path_worker::~path_worker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void path_worker::model_changed(game_data& game) {
+    std::lock_guard<std::mutex> lock(mutex);
+    walls = game.model.get_cells();
+    walls_changed = true;
+}
+
+void path_worker::request(game_data& game) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.tick = game.tick;
+        pending.heroes.resize(game.heroes_data.size());
+        for (size_t i = 0; i < game.heroes_data.size(); i++) {
+            pending.heroes[i] = pos{ game.heroes_data[i]->pos_x, game.heroes_data[i]->pos_y };
+        }
+        pending.bad_guys.resize(game.bad_guys_data.size());
+        for (size_t i = 0; i < game.bad_guys_data.size(); i++) {
+            actor_data& bad_guy = *game.bad_guys_data[i];
+            pending.bad_guys[i] = pos{ int(bad_guy.pos_fx + 0.5), int(bad_guy.pos_fy + 0.5) };
+        }
+        requested = true;
+    }
+    wake.notify_one();
+}
+
+void path_worker::apply(game_data& game) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const decisions& d = results[published];
+    if (d.tick < 0) return;
+    size_t count = std::min(d.bad_guys.size(), game.bad_guys_data.size());
+    for (size_t i = 0; i < count; i++) {
+        actor_data& bad_guy = *game.bad_guys_data[i];
+        decision dec = d.bad_guys[i];
+        pos cell{ int(bad_guy.pos_fx + 0.5), int(bad_guy.pos_fy + 0.5) };
+        if (dec.chasing && dec.cell == cell) {
+            bad_guy.next_direction = dec.way;
+        }
+    }
+}
+
+long path_worker::get_lag(game_data& game) {
+    std::lock_guard<std::mutex> lock(mutex);
+    long tick = results[published].tick;
+    return tick < 0 ? -1 : game.tick - tick;
+}
+
+void path_worker::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return stopping || requested; });
+        if (stopping) return;
+        requested = false;
+        // the copies reuse the buffers of the previous requests
+        current.tick = pending.tick;
+        current.heroes.assign(pending.heroes.begin(), pending.heroes.end());
+        current.bad_guys.assign(pending.bad_guys.begin(), pending.bad_guys.end());
+        if (walls_changed) {
+            model.get_cells().swap(walls);
+            walls_changed = false;
+        }
+        decisions& d = results[1 - published];
+        lock.unlock();
+        search(current, d);
+        lock.lock();
+        published = 1 - published;
+    }
+}
+
+void path_worker::search(const positions& p, decisions& d) {
+    d.tick = p.tick;
+    if (p.heroes.empty()) {
+        d.bad_guys.clear();
+        return;
+    }
+    // the view gets as many actors as the game, the heroes only need a cell
+    // and the bad guys a position rounding to theirs
+    while (view.heroes_data.size() < p.heroes.size()) {
+        view.heroes_data.push_back(std::make_shared<actor_data>());
+    }
+    view.heroes_data.resize(p.heroes.size());
+    while (view.bad_guys_data.size() < p.bad_guys.size()) {
+        view.bad_guys_data.push_back(std::make_shared<actor_data>());
+    }
+    view.bad_guys_data.resize(p.bad_guys.size());
+    for (size_t i = 0; i < p.heroes.size(); i++) {
+        view.heroes_data[i]->pos_x = p.heroes[i].x;
+        view.heroes_data[i]->pos_y = p.heroes[i].y;
+    }
+    for (size_t i = 0; i < p.bad_guys.size(); i++) {
+        view.bad_guys_data[i]->pos_fx = (float) p.bad_guys[i].x;
+        view.bad_guys_data[i]->pos_fy = (float) p.bad_guys[i].y;
+    }
+    size_t count = p.bad_guys.size();
+    view.arena.reset();
+    direction* ways = view.arena.allocate_array<direction>(count);
+    bool* chasing = view.arena.allocate_array<bool>(count);
+    find_chasing_directions(view, ways, chasing);
+    d.bad_guys.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        d.bad_guys[i] = decision{ p.bad_guys[i], chasing[i], ways[i] };
+    }
+}
+
+void update_game(game_data& game, path_worker& paths) {
+    move_actors(game);
+    paths.apply(game);
+    wander(game);
+    game.tick++;
+    paths.request(game);
+}
@@ -0,0 +1,74 @@
+#ifndef _path_worker_hpp_
+#define _path_worker_hpp_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "game.hpp"
+
+// The bad guys' path finding on a thread of its own, for play(). Every frame
+// hands the worker the cells of the actors and takes the decisions of the
+// last search that completed, so that a slow search on a big maze delays
+// the decisions instead of the frame. A decision only applies to a bad guy
+// still on the cell it was made for. The decisions depend on the timing of
+// the thread, so the batch runs, lockstep games and benchmarks keep
+// update_game, which replays from a seed.
+class path_worker {
+public:
+    // the worker searches a copy of the walls of game.model
+    path_worker(game_data& game);
+    ~path_worker();
+    // the walls of the game changed, the next search takes a copy of them
+    void model_changed(game_data& game);
+    // the cells of the actors now, replacing a request not started yet
+    void request(game_data& game);
+    // the ways of the latest decisions to the bad guys they are for
+    void apply(game_data& game);
+    // the ticks between the game and the cells of the latest decisions
+    long get_lag(game_data& game);
+private:
+    struct decision {
+        pos cell;
+        bool chasing;
+        direction way;
+    };
+
+    struct decisions {
+        long tick;
+        std::vector<decision> bad_guys;
+    };
+
+    struct positions {
+        long tick;
+        std::vector<pos> heroes;
+        std::vector<pos> bad_guys;
+    };
+
+    path_worker(const path_worker&);
+    void run();
+    void search(const positions& p, decisions& d);
+
+    maze_model model;
+    // the actors of the request being searched, on the copy of the walls
+    game_data view;
+    std::mutex mutex;
+    std::condition_variable wake;
+    positions pending;
+    positions current;
+    bool requested;
+    std::vector<cell> walls;
+    bool walls_changed;
+    // published is read by the game, the other one written by the worker
+    decisions results[2];
+    int published;
+    bool stopping;
+    std::thread thread;
+};
+
+// update_game with the ways of the bad guys from paths, the bad guys
+// without one wander
+void update_game(game_data& game, path_worker& paths);
+
+#endif
@@ -1,176 +1,419 @@
-#include <fstream>
-#include <sstream>
-
-#include "program.hpp"
-#include "misc.hpp"
-#include "context.hpp"
-
-static std::string	read_text_file(const std::string& filename) {
-    std::ifstream f(filename);
-    std::stringstream buffer;
-    buffer << f.rdbuf();
-    return buffer.str();
-}
-
-static void check_shader_compile_status(GLuint shaderId) {
-    GLint compileStatus;
-    glGetShaderiv(shaderId, GL_COMPILE_STATUS, &compileStatus);
-    if (compileStatus == GL_FALSE) {
-        GLint infoLogLength;
-        glGetShaderiv(shaderId, GL_INFO_LOG_LENGTH, &infoLogLength);
-        printf("Shader compilation failed...\n");
-        char* log = (char*) malloc((1+infoLogLength)*sizeof(char));
-        glGetShaderInfoLog(shaderId, infoLogLength, NULL, log);
-        log[infoLogLength] = 0;
-        printf("%s", log);
-    }
-}
-
-static void checkProgramLinkStatus(GLuint programId) {
-    GLint linkStatus;
-    glGetProgramiv(programId, GL_LINK_STATUS, &linkStatus);
-    if (linkStatus == GL_FALSE) {
-        GLint infoLogLength;
-        glGetProgramiv(programId, GL_INFO_LOG_LENGTH, &infoLogLength);
-        printf("Program link failed...\n");
-        char* log = (char*) malloc((1+infoLogLength)*sizeof(char));
-        glGetProgramInfoLog(programId, infoLogLength, NULL, log);
-        log[infoLogLength] = 0;
-        printf("%s", log);
-    }
-}
-
-template <GLenum type>
-shader<type>::shader(const std::string& source) {
-    id = glCreateShader(type);
-    const GLchar* str = source.c_str();
-    const GLint length = source.length();
-    glShaderSource(id, 1, &str, &length);
-    glCompileShader(id);
-    check_shader_compile_status(id);
-}
-
-template <GLenum type>
-shader<type>::~shader() {
-    glDeleteShader(id);
-}
-
-template <GLenum type>
-GLuint shader<type>::get_id() const {
-    return id;
-}
-
-program::program(const std::string& vertexShaderSource,
-                 const std::string& fragmentShaderSource,
-                 const std::map<int, std::string>& attributeIndices) :
-    vertex_shader(vertexShaderSource),
-    fragment_shader(fragmentShaderSource)
-{
-    id = glCreateProgram();
-    glAttachShader(id, vertex_shader.get_id());
-    glAttachShader(id, fragment_shader.get_id());
-    for (auto it = attributeIndices.begin(); it != attributeIndices.end(); it++) {
-        glBindAttribLocation(id, it->first, it->second.c_str());
-    }
-    glLinkProgram(id);
-    checkProgramLinkStatus(id);
-}
-
-program::~program() {
-    glDeleteProgram(id);
-}
-
-void monochrome_program::render(const geometry<float>& geometry, rendering_context& ctx) {
-    glUseProgram(id);
-    GLuint matrixUniform = glGetUniformLocation(id, "mvpMatrix");
-    glUniformMatrix4fv(matrixUniform, 1, false, ctx.mvp().m);
-    GLuint colorUniform = glGetUniformLocation(id, "color");
-    glUniform4f(colorUniform, col.r(), col.g(), col.b(), col.a());
-    glEnableVertexAttribArray(vertex_attribute::POSITION);
-    glBindBuffer(GL_ARRAY_BUFFER, geometry.get_positions_id());
-    glVertexAttribPointer(vertex_attribute::POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glDrawArrays(GL_QUADS, 0, geometry.get_count());
-    glDisableVertexAttribArray(vertex_attribute::POSITION);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glUseProgram(id);
-}
-
-std::shared_ptr<monochrome_program> monochrome_program::create() {
-    std::map<int, std::string> monochromeAttributeIndices;
-    monochromeAttributeIndices[vertex_attribute::POSITION] = "vpos";
-    return std::shared_ptr<monochrome_program>(new monochrome_program(monochromeAttributeIndices));
-}
-
-monochrome_program::monochrome_program(const std::map<int, std::string>& attributeIndices) :
-    program(read_text_file("monochrome.vert"), read_text_file("monochrome.frag"), attributeIndices) {}
-
-void texture_program::render(const geometry<float>& geometry, rendering_context& ctx) {
-    glUseProgram(id);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, current_texture->get_id());
-    GLuint matrixUniform = glGetUniformLocation(id, "mvpMatrix");
-    glUniformMatrix4fv(matrixUniform, 1, false, ctx.mvp().m);
-    GLuint textureUniform = glGetUniformLocation(id, "texture");
-    glUniform1i(textureUniform, 0); // we pass the texture unit
-    glEnableVertexAttribArray(vertex_attribute::POSITION);
-    glBindBuffer(GL_ARRAY_BUFFER, geometry.get_positions_id());
-    glVertexAttribPointer(vertex_attribute::POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(vertex_attribute::TEXCOORD);
-    glBindBuffer(GL_ARRAY_BUFFER, geometry.get_tex_coords_id());
-    glVertexAttribPointer(vertex_attribute::TEXCOORD, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glDrawArrays(GL_QUADS, 0, 4);
-    glDisableVertexAttribArray(vertex_attribute::POSITION);
-    glDisableVertexAttribArray(vertex_attribute::TEXCOORD);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
-
-void texture_program::set_texture(std::shared_ptr<texture> t) {
-    current_texture = t;
-}
-
-std::shared_ptr<texture_program> texture_program::create() {
-    std::map<int, std::string> textureAttributeIndices;
-    textureAttributeIndices[vertex_attribute::POSITION] = "pos";
-    textureAttributeIndices[vertex_attribute::TEXCOORD] = "texCoord";
-    return std::shared_ptr<texture_program>(new texture_program(textureAttributeIndices));
-}
-
-texture_program::texture_program(std::map<int, std::string>& attributeIndices) :
-    program(read_text_file("texture.vert"), read_text_file("texture.frag"), attributeIndices) {}
-
-void flat_shading_program::render(const geometry<float>& geometry, rendering_context& ctx) {
-    glUseProgram(id);
-
-    GLuint mvpUniform = glGetUniformLocation(id, "mvpMatrix");
-    glUniformMatrix4fv(mvpUniform, 1, false, ctx.mvp().m);
-
-    GLuint mvUniform = glGetUniformLocation(id, "mvMatrix");
-    glUniformMatrix4fv(mvUniform, 1, false, ctx.mv().m);
-
-    GLuint lightDirUniform = glGetUniformLocation(id, "lightDir");
-    glUniform3f(lightDirUniform, ctx.dir.v[0], ctx.dir.v[1], ctx.dir.v[2]);
-
-    GLuint colorUniform = glGetUniformLocation(id, "color");
-    glUniform3f(colorUniform, col.r(), col.g(), col.b());
-
-    glEnableVertexAttribArray(vertex_attribute::POSITION);
-    glBindBuffer(GL_ARRAY_BUFFER, geometry.get_positions_id());
-    glVertexAttribPointer(vertex_attribute::POSITION, 3, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(vertex_attribute::NORMAL);
-    glBindBuffer(GL_ARRAY_BUFFER, geometry.get_normals_id());
-    glVertexAttribPointer(vertex_attribute::NORMAL, 3, GL_FLOAT, GL_FALSE, 0, 0);
-    glDrawArrays(GL_QUADS, 0, geometry.get_count());
-    glDisableVertexAttribArray(vertex_attribute::POSITION);
-    glDisableVertexAttribArray(vertex_attribute::NORMAL);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
-
-std::shared_ptr<flat_shading_program> flat_shading_program::Create() {
-    std::map<int, std::string> attributeIndices;
-    attributeIndices[vertex_attribute::POSITION] = "vPosition";
-    attributeIndices[vertex_attribute::NORMAL] = "vNormal";
-    return std::shared_ptr<flat_shading_program>(new flat_shading_program(attributeIndices));
-}
-
-flat_shading_program::flat_shading_program(const std::map<int, std::string>& attributeIndices) :
-    program(read_text_file("flatShading.vert"), read_text_file("flatShading.frag"), attributeIndices) {}
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "program.hpp"
+#include "misc.hpp"
+#include "context.hpp"
+#include "state.hpp"
+#include "queue.hpp"
+#include "assets.hpp"
+
+static std::string	read_text_file(const std::string& filename) {
+    return *asset_loader::get().text(filename).get();
+}
+
+static void check_shader_compile_status(GLuint shaderId) {
+    GLint compileStatus;
+    glGetShaderiv(shaderId, GL_COMPILE_STATUS, &compileStatus);
+    if (compileStatus == GL_FALSE) {
+        GLint infoLogLength;
+        glGetShaderiv(shaderId, GL_INFO_LOG_LENGTH, &infoLogLength);
+        printf("Shader compilation failed...\n");
+        std::vector<char> log(infoLogLength + 1, 0);
+        glGetShaderInfoLog(shaderId, infoLogLength, NULL, &log[0]);
+        printf("%s", &log[0]);
+    }
+}
+
+static bool checkProgramLinkStatus(GLuint programId) {
+    GLint linkStatus;
+    glGetProgramiv(programId, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE) {
+        GLint infoLogLength;
+        glGetProgramiv(programId, GL_INFO_LOG_LENGTH, &infoLogLength);
+        printf("Program link failed...\n");
+        std::vector<char> log(infoLogLength + 1, 0);
+        glGetProgramInfoLog(programId, infoLogLength, NULL, &log[0]);
+        printf("%s", &log[0]);
+        return false;
+    }
+    return true;
+}
+
+// Linked programs are cached on disk with glGetProgramBinary, under a hash
+// of everything the binary depends on. Any failure silently falls back to
+// compiling from source.
+static const char* program_cache_directory = "shader_cache";
+
+static bool program_binary_supported() {
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+static void hash_string(uint64_t& h, const char* s) {
+    // FNV-1a, with the terminating zero so that concatenations differ
+    do {
+        h ^= (unsigned char)*s;
+        h *= 1099511628211ULL;
+    } while (*s++);
+}
+
+static std::string program_binary_path(const std::string& vertexShaderSource,
+                                       const std::string& fragmentShaderSource,
+                                       const std::map<int, std::string>& attributeIndices) {
+    uint64_t h = 14695981039346656037ULL;
+    hash_string(h, vertexShaderSource.c_str());
+    hash_string(h, fragmentShaderSource.c_str());
+    for (auto it = attributeIndices.begin(); it != attributeIndices.end(); it++) {
+        hash_string(h, std::to_string(it->first).c_str());
+        hash_string(h, it->second.c_str());
+    }
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const GLubyte* value = glGetString(name);
+        hash_string(h, value ? (const char*)value : "");
+    }
+    char file[32];
+    snprintf(file, sizeof(file), "%016llx.bin", (unsigned long long)h);
+    return std::string(program_cache_directory) + "/" + file;
+}
+
+static bool load_program_binary(GLuint programId, const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    GLenum format;
+    if (!f.read((char*)&format, sizeof(format))) return false;
+    std::vector<char> binary((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (binary.empty()) return false;
+    glProgramBinary(programId, format, &binary[0], (GLsizei)binary.size());
+    GLint linkStatus;
+    glGetProgramiv(programId, GL_LINK_STATUS, &linkStatus);
+    return linkStatus == GL_TRUE;
+}
+
+static void save_program_binary(GLuint programId, const std::string& path) {
+    GLint length = 0;
+    glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> binary(length);
+    GLenum format;
+    glGetProgramBinary(programId, length, NULL, &format, &binary[0]);
+#ifdef _WIN32
+    _mkdir(program_cache_directory);
+#else
+    mkdir(program_cache_directory, 0755);
+#endif
+    // written aside then renamed into place, so that a crash or another
+    // instance writing the same binary never leaves a partial file to load
+    std::string temporary = path + "." + std::to_string(getpid()) + ".tmp";
+    bool written;
+    {
+        std::ofstream f(temporary, std::ios::binary);
+        f.write((const char*)&format, sizeof(format));
+        f.write(&binary[0], binary.size());
+        f.close();
+        written = !f.fail();
+    }
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+    }
+}
+
+template <GLenum type>
+shader<type>::shader(const std::string& source) {
+    id = glCreateShader(type);
+    const GLchar* str = source.c_str();
+    const GLint length = source.length();
+    glShaderSource(id, 1, &str, &length);
+    glCompileShader(id);
+    check_shader_compile_status(id);
+}
+
+template <GLenum type>
+shader<type>::~shader() {
+    glDeleteShader(id);
+}
+
+template <GLenum type>
+GLuint shader<type>::get_id() const {
+    return id;
+}
+
+program::program(const std::string& vertexShaderSource,
+                 const std::string& fragmentShaderSource,
+                 const std::map<int, std::string>& attributeIndices)
+{
+    static unsigned programs = 0;
+    sort_id = programs++;
+    id = glCreateProgram();
+    bool cached = program_binary_supported();
+    std::string path;
+    if (cached) {
+        path = program_binary_path(vertexShaderSource, fragmentShaderSource, attributeIndices);
+        if (load_program_binary(id, path)) return;
+    }
+    shader<GL_VERTEX_SHADER> vertex_shader(vertexShaderSource);
+    shader<GL_FRAGMENT_SHADER> fragment_shader(fragmentShaderSource);
+    glAttachShader(id, vertex_shader.get_id());
+    glAttachShader(id, fragment_shader.get_id());
+    for (auto it = attributeIndices.begin(); it != attributeIndices.end(); it++) {
+        glBindAttribLocation(id, it->first, it->second.c_str());
+    }
+    if (cached) {
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(id);
+    if (checkProgramLinkStatus(id) && cached) {
+        save_program_binary(id, path);
+    }
+    // the shaders are deleted when going out of scope
+    glDetachShader(id, vertex_shader.get_id());
+    glDetachShader(id, fragment_shader.get_id());
+}
+
+program::~program() {
+    glDeleteProgram(id);
+    gl_state::get().invalidate();
+}
+
+void program::render(const geometry<float>& geometry, rendering_context& ctx) {
+    draw_item item(this, geometry, ctx);
+    prepare(item);
+    bind(item);
+    draw(item);
+}
+
+void program::draw_run(const draw_item* const* run, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        draw(*run[i]);
+    }
+}
+
+void monochrome_program::prepare(draw_item& item) const {
+    item.col = col;
+}
+
+void monochrome_program::bind(const draw_item& item) {
+    gl_state::get().use_program(id);
+    gl_state::get().uniform(color_uniform, item.col.r(), item.col.g(), item.col.b(), item.col.a());
+}
+
+void monochrome_program::draw(const draw_item& item) {
+    gl_state::get().uniform_matrix(mvp_uniform, item.mvp.m);
+    gl_state::get().bind_vertex_array(item.geom->get_vertex_array(inputs));
+    item.geom->draw(GL_QUADS);
+}
+
+void monochrome_program::draw_run(const draw_item* const* run, size_t count) {
+    const geometry<float>& geom = *run[0]->geom;
+    // a geometry with instances of its own cannot be copied
+    if (count == 1 || geom.get_instance_count() > 0) {
+        program::draw_run(run, count);
+        return;
+    }
+    gl_state& state = gl_state::get();
+    state.bind_vertex_array(geom.get_vertex_array(inputs));
+    for (size_t first = 0; first < count; first += max_run) {
+        size_t copies = std::min(count - first, (size_t) max_run);
+        for (size_t i = 0; i < copies; i++) {
+            std::copy(run[first + i]->mvp.m, run[first + i]->mvp.m + 16, run_mvps + 16 * i);
+        }
+        state.uniform_matrix(mvp_uniform, (GLsizei) copies, run_mvps);
+        geom.draw_copies(GL_QUADS, (GLsizei) copies);
+    }
+}
+
+std::shared_ptr<monochrome_program> monochrome_program::create() {
+    std::map<int, std::string> monochromeAttributeIndices;
+    monochromeAttributeIndices[vertex_attribute::POSITION] = "vpos";
+    return std::shared_ptr<monochrome_program>(new monochrome_program(monochromeAttributeIndices));
+}
+
+monochrome_program::monochrome_program(const std::map<int, std::string>& attributeIndices) :
+    program(read_text_file("monochrome.vert"), read_text_file("monochrome.frag"), attributeIndices)
+{
+    inputs.add(vertex_attribute::POSITION, 2);
+    mvp_uniform = glGetUniformLocation(id, "mvpMatrices");
+    color_uniform = glGetUniformLocation(id, "color");
+}
+
+void grid_program::prepare(draw_item& item) const {
+    item.tex = grid->get_id();
+    item.col = col;
+}
+
+void grid_program::bind(const draw_item& item) {
+    gl_state& state = gl_state::get();
+    state.use_program(id);
+    state.bind_texture(GL_TEXTURE0, item.tex);
+    state.uniform(color_uniform, item.col.r(), item.col.g(), item.col.b(), item.col.a());
+}
+
+void grid_program::draw(const draw_item& item) {
+    gl_state::get().uniform_matrix(mvp_uniform, item.mvp.m);
+    gl_state::get().bind_vertex_array(item.geom->get_vertex_array(inputs));
+    item.geom->draw(GL_QUADS);
+}
+
+void grid_program::set_grid(std::shared_ptr<grid_texture> g) {
+    grid = g;
+}
+
+std::shared_ptr<grid_program> grid_program::create() {
+    std::map<int, std::string> attributeIndices;
+    attributeIndices[vertex_attribute::POSITION] = "vpos";
+    return std::shared_ptr<grid_program>(new grid_program(attributeIndices));
+}
+
+grid_program::grid_program(const std::map<int, std::string>& attributeIndices) :
+    program(read_text_file("grid.vert"), read_text_file("grid.frag"), attributeIndices)
+{
+    inputs.add(vertex_attribute::POSITION, 2);
+    mvp_uniform = glGetUniformLocation(id, "mvpMatrix");
+    color_uniform = glGetUniformLocation(id, "color");
+    gl_state::get().use_program(id);
+    gl_state::get().uniform(glGetUniformLocation(id, "grid"), 0); // we pass the texture unit
+}
+
+void texture_program::prepare(draw_item& item) const {
+    item.tex = current_texture->get_id();
+}
+
+void texture_program::bind(const draw_item& item) {
+    gl_state& state = gl_state::get();
+    state.use_program(id);
+    state.bind_texture(GL_TEXTURE0, item.tex);
+}
+
+void texture_program::draw(const draw_item& item) {
+    gl_state::get().uniform_matrix(mvp_uniform, item.mvp.m);
+    gl_state::get().bind_vertex_array(item.geom->get_vertex_array(inputs));
+    item.geom->draw(GL_QUADS);
+}
+
+void texture_program::set_texture(std::shared_ptr<texture> t) {
+    current_texture = t;
+}
+
+std::shared_ptr<texture_program> texture_program::create() {
+    std::map<int, std::string> textureAttributeIndices;
+    textureAttributeIndices[vertex_attribute::POSITION] = "pos";
+    textureAttributeIndices[vertex_attribute::TEXCOORD] = "texCoord";
+    return std::shared_ptr<texture_program>(new texture_program(textureAttributeIndices));
+}
+
+texture_program::texture_program(std::map<int, std::string>& attributeIndices) :
+    program(read_text_file("texture.vert"), read_text_file("texture.frag"), attributeIndices)
+{
+    inputs.add(vertex_attribute::POSITION, 2);
+    inputs.add(vertex_attribute::TEXCOORD, 2);
+    mvp_uniform = glGetUniformLocation(id, "mvpMatrix");
+    gl_state::get().use_program(id);
+    gl_state::get().uniform(glGetUniformLocation(id, "texture"), 0); // we pass the texture unit
+}
+
+void flat_shading_program::prepare(draw_item& item) const {
+    item.col = col;
+}
+
+void flat_shading_program::bind(const draw_item& item) {
+    gl_state::get().use_program(id);
+    gl_state::get().uniform(light_dir_uniform, item.dir.v[0], item.dir.v[1], item.dir.v[2]);
+    gl_state::get().uniform(color_uniform, item.col.r(), item.col.g(), item.col.b());
+}
+
+void flat_shading_program::draw(const draw_item& item) {
+    gl_state::get().uniform_matrix(mvp_uniform, item.mvp.m);
+    gl_state::get().uniform_matrix(mv_uniform, item.mv.m);
+    gl_state::get().bind_vertex_array(item.geom->get_vertex_array(inputs));
+    item.geom->draw(GL_QUADS);
+}
+
+std::shared_ptr<flat_shading_program> flat_shading_program::Create() {
+    std::map<int, std::string> attributeIndices;
+    attributeIndices[vertex_attribute::POSITION] = "vPosition";
+    attributeIndices[vertex_attribute::NORMAL] = "vNormal";
+    return std::shared_ptr<flat_shading_program>(new flat_shading_program(attributeIndices));
+}
+
+flat_shading_program::flat_shading_program(const std::map<int, std::string>& attributeIndices) :
+    program(read_text_file("flatShading.vert"), read_text_file("flatShading.frag"), attributeIndices)
+{
+    inputs.add(vertex_attribute::POSITION, 3);
+    inputs.add(vertex_attribute::NORMAL, 3);
+    mvp_uniform = glGetUniformLocation(id, "mvpMatrix");
+    mv_uniform = glGetUniformLocation(id, "mvMatrix");
+    light_dir_uniform = glGetUniformLocation(id, "lightDir");
+    color_uniform = glGetUniformLocation(id, "color");
+}
+
+void sprite_program::prepare(draw_item& item) const {
+    item.tex = current_texture->get_id();
+}
+
+void sprite_program::bind(const draw_item& item) {
+    gl_state& state = gl_state::get();
+    state.use_program(id);
+    state.bind_texture(GL_TEXTURE0, item.tex);
+    if (sprites_changed) {
+        state.uniform_4fv(sprites_uniform, max_sprites, &sprites[0].v[0]);
+        sprites_changed = false;
+    }
+}
+
+void sprite_program::draw(const draw_item& item) {
+    gl_state::get().uniform_matrix(mvp_uniform, item.mvp.m);
+    gl_state::get().bind_vertex_array(item.geom->get_vertex_array(inputs));
+    item.geom->draw(GL_QUADS);
+}
+
+void sprite_program::set_texture(std::shared_ptr<texture> t) {
+    current_texture = t;
+}
+
+void sprite_program::set_sprite(int index, float u, float v, float width, float height) {
+    sprites[index] = vector4(u, v, width, height);
+    sprites_changed = true;
+}
+
+void sprite_program::set_atlas(std::shared_ptr<texture_atlas> atlas) {
+    set_texture(atlas->get_texture());
+    for (int i = 0; i < atlas->get_sprite_count() && i < max_sprites; i++) {
+        const atlas_rect& r = atlas->get_rect(i);
+        set_sprite(i, r.u, r.v, r.width, r.height);
+    }
+}
+
+std::shared_ptr<sprite_program> sprite_program::create() {
+    std::map<int, std::string> attributeIndices;
+    attributeIndices[vertex_attribute::POSITION] = "pos";
+    attributeIndices[vertex_attribute::TEXCOORD] = "texCoord";
+    attributeIndices[vertex_attribute::INSTANCE] = "instance";
+    return std::shared_ptr<sprite_program>(new sprite_program(attributeIndices));
+}
+
+sprite_program::sprite_program(const std::map<int, std::string>& attributeIndices) :
+    program(read_text_file("sprite.vert"), read_text_file("texture.frag"), attributeIndices),
+    sprites(max_sprites, vector4(0.0f, 0.0f, 1.0f, 1.0f)),
+    sprites_changed(true)
+{
+    inputs.add(vertex_attribute::POSITION, 2);
+    inputs.add(vertex_attribute::TEXCOORD, 2);
+    inputs.add(vertex_attribute::INSTANCE, 3);
+    mvp_uniform = glGetUniformLocation(id, "mvpMatrix");
+    sprites_uniform = glGetUniformLocation(id, "sprites");
+    gl_state::get().use_program(id);
+    gl_state::get().uniform(glGetUniformLocation(id, "texture"), 0); // we pass the texture unit
+}
@@ -1,74 +1,147 @@
-#ifndef _program_hpp_
-#define _program_hpp_
-
-#include <string>
-#include <map>
-#include <memory>
-#include <GL/glew.h>
-
-#include "matrix.hpp"
-#include "geometry.hpp"
-#include "texture.hpp"
-
-class rendering_context;
-
-template <class T>
-class geometry;
-
-template <GLenum type>
-class shader {
-public:
-    shader(const std::string& source);
-    ~shader();
-    GLuint get_id() const;
-private:
-    GLuint id;
-    shader(const shader&);
-};
-
-class program {
-public:
-    program(const std::string& vertex_shader_source,
-            const std::string& fragment_shader_source,
-            const std::map<int, std::string>& attribute_indices);
-    virtual void render(const geometry<float>& geometry, rendering_context& ctx) = 0;
-    ~program();
-protected:
-    GLuint id;
-private:
-    shader<GL_VERTEX_SHADER> vertex_shader;
-    shader<GL_FRAGMENT_SHADER> fragment_shader;
-    program(const program& that);
-};
-
-class monochrome_program : public program {
-public:
-    virtual void render(const geometry<float>& geometry, rendering_context& ctx);
-    inline void set_color(color col) { this->col = col; }
-    static std::shared_ptr<monochrome_program> create();
-private:
-    monochrome_program(const std::map<int, std::string>& attribute_indices);
-    color col;
-};
-
-class texture_program : public program {
-public:
-    virtual void render(const geometry<float>& geometry, rendering_context& ctx);
-    void set_texture(std::shared_ptr<texture> t);
-    static std::shared_ptr<texture_program> create();
-private:
-    texture_program(std::map<int, std::string>& attribute_indices);
-    std::shared_ptr<texture> current_texture;
-};
-
-class flat_shading_program : public program {
-public:
-    virtual void render(const geometry<float>& geometry, rendering_context& ctx);
-    inline void set_color(color col) { this->col = col; }
-    static std::shared_ptr<flat_shading_program> Create();
-private:
-    flat_shading_program(const std::map<int, std::string>& attribute_indices);
-    color col;
-};
-
-#endif
+#ifndef _program_hpp_
+#define _program_hpp_
+
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <GL/glew.h>
+
+#include "matrix.hpp"
+#include "geometry.hpp"
+#include "texture.hpp"
+
+class rendering_context;
+struct draw_item;
+
+template <class T>
+class geometry;
+
+template <GLenum type>
+class shader {
+public:
+    shader(const std::string& source);
+    ~shader();
+    GLuint get_id() const;
+private:
+    GLuint id;
+    shader(const shader&);
+};
+
+class program {
+public:
+    program(const std::string& vertex_shader_source,
+            const std::string& fragment_shader_source,
+            const std::map<int, std::string>& attribute_indices);
+    void render(const geometry<float>& geometry, rendering_context& ctx);
+    // copies the material state (color, texture...) into the item
+    virtual void prepare(draw_item&) const {}
+    // makes the program and the item material current
+    virtual void bind(const draw_item& item) = 0;
+    // sets the per item uniforms and issues the draw call
+    virtual void draw(const draw_item& item) = 0;
+    // draws a run of items sharing the material and the geometry, one draw
+    // call each unless the program can merge them
+    virtual void draw_run(const draw_item* const* run, size_t count);
+    // the order of creation, for sorting draws the same way every run
+    unsigned get_sort_id() const { return sort_id; }
+    ~program();
+protected:
+    GLuint id;
+    vertex_layout inputs;
+private:
+    program(const program& that);
+    unsigned sort_id;
+};
+
+class monochrome_program : public program {
+public:
+    virtual void prepare(draw_item& item) const;
+    virtual void bind(const draw_item& item);
+    virtual void draw(const draw_item& item);
+    // the copies of a geometry in one instanced draw per max_run items
+    virtual void draw_run(const draw_item* const* run, size_t count);
+    inline void set_color(color col) { this->col = col; }
+    static std::shared_ptr<monochrome_program> create();
+    // the size of the matrix array of monochrome.vert
+    static const int max_run = 16;
+private:
+    monochrome_program(const std::map<int, std::string>& attribute_indices);
+    color col;
+    GLfloat run_mvps[16 * max_run];
+    GLint mvp_uniform;
+    GLint color_uniform;
+};
+
+// Draws a grid, typically one quad over the whole maze, coloring the
+// fragments whose cell is set in a grid texture and discarding the others.
+// The input positions are in cells.
+class grid_program : public program {
+public:
+    virtual void prepare(draw_item& item) const;
+    virtual void bind(const draw_item& item);
+    virtual void draw(const draw_item& item);
+    inline void set_color(color col) { this->col = col; }
+    void set_grid(std::shared_ptr<grid_texture> g);
+    static std::shared_ptr<grid_program> create();
+private:
+    grid_program(const std::map<int, std::string>& attribute_indices);
+    color col;
+    std::shared_ptr<grid_texture> grid;
+    GLint mvp_uniform;
+    GLint color_uniform;
+};
+
+class texture_program : public program {
+public:
+    virtual void prepare(draw_item& item) const;
+    virtual void bind(const draw_item& item);
+    virtual void draw(const draw_item& item);
+    void set_texture(std::shared_ptr<texture> t);
+    static std::shared_ptr<texture_program> create();
+private:
+    texture_program(std::map<int, std::string>& attribute_indices);
+    std::shared_ptr<texture> current_texture;
+    GLint mvp_uniform;
+};
+
+class flat_shading_program : public program {
+public:
+    virtual void prepare(draw_item& item) const;
+    virtual void bind(const draw_item& item);
+    virtual void draw(const draw_item& item);
+    inline void set_color(color col) { this->col = col; }
+    static std::shared_ptr<flat_shading_program> Create();
+private:
+    flat_shading_program(const std::map<int, std::string>& attribute_indices);
+    color col;
+    GLint mvp_uniform;
+    GLint mv_uniform;
+    GLint light_dir_uniform;
+    GLint color_uniform;
+};
+
+// Draws every instance of a geometry in one call. Each instance carries its
+// position (x, y) and a sprite selector, an index in a table of texture
+// rectangles (u, v, width, height) which all default to the whole texture,
+// or are the sprites of an atlas.
+class sprite_program : public program {
+public:
+    virtual void prepare(draw_item& item) const;
+    virtual void bind(const draw_item& item);
+    virtual void draw(const draw_item& item);
+    void set_texture(std::shared_ptr<texture> t);
+    void set_sprite(int index, float u, float v, float width, float height);
+    void set_atlas(std::shared_ptr<texture_atlas> atlas);
+    static std::shared_ptr<sprite_program> create();
+    static const int max_sprites = 8;
+private:
+    sprite_program(const std::map<int, std::string>& attribute_indices);
+    std::shared_ptr<texture> current_texture;
+    std::vector<vector4> sprites;
+    bool sprites_changed;
+    GLint mvp_uniform;
+    GLint sprites_uniform;
+};
+
+#endif
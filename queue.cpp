@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "queue.hpp"
+#include "program.hpp"
+#include "context.hpp"
+#include "gl_stats.hpp"
+
+draw_item::draw_item(program* prog, const geometry<float>& geom, const rendering_context& ctx) :
+    prog(prog), tex(0), geom(&geom), mvp(ctx.mvp()), mv(ctx.mv()), dir(ctx.dir) {}
+
+static bool same_color(const color& c1, const color& c2) {
+    return std::equal(c1.v, c1.v + 4, c2.v);
+}
+
+static bool same_material(const draw_item& i1, const draw_item& i2) {
+    return i1.prog == i2.prog && i1.tex == i2.tex && same_color(i1.col, i2.col) &&
+           std::equal(i1.dir.v, i1.dir.v + 3, i2.dir.v);
+}
+
+// by the keys of same_material, then by geometry, so that the items drawn
+// with the same state follow each other
+static bool before(const draw_item& i1, const draw_item& i2) {
+    if (i1.prog != i2.prog) return i1.prog->get_sort_id() < i2.prog->get_sort_id();
+    if (i1.tex != i2.tex) return i1.tex < i2.tex;
+    if (!same_color(i1.col, i2.col)) return std::lexicographical_compare(i1.col.v, i1.col.v + 4, i2.col.v, i2.col.v + 4);
+    if (!std::equal(i1.dir.v, i1.dir.v + 3, i2.dir.v)) return std::lexicographical_compare(i1.dir.v, i1.dir.v + 3, i2.dir.v, i2.dir.v + 3);
+    return i1.geom < i2.geom;
+}
+
+void render_queue::push(const geometry<float>& geom, rendering_context& ctx) {
+    items.push_back(draw_item(ctx.prog.get(), geom, ctx));
+    ctx.prog->prepare(items.back());
+}
+
+void render_queue::flush() {
+    order.clear();
+    for (size_t i = 0; i < items.size(); i++) {
+        order.push_back(i);
+    }
+    // stable without the temporary buffer of std::stable_sort, so that
+    // flushing does not allocate
+    std::sort(order.begin(), order.end(), [this](size_t i1, size_t i2) {
+        if (before(items[i1], items[i2])) return true;
+        if (before(items[i2], items[i1])) return false;
+        return i1 < i2;
+    });
+    const draw_item* previous = nullptr;
+    size_t i = 0;
+    while (i < order.size()) {
+        const draw_item& item = items[order[i]];
+        if (previous == nullptr || !same_material(*previous, item)) {
+            item.prog->bind(item);
+            gl_stats::get().material_bind();
+        }
+        // the sort puts the items of a geometry next to each other
+        run.clear();
+        for (; i < order.size(); i++) {
+            const draw_item& next = items[order[i]];
+            if (next.geom != item.geom || !same_material(item, next)) break;
+            run.push_back(&next);
+        }
+        item.prog->draw_run(&run[0], run.size());
+        previous = &item;
+    }
+    items.clear();
+}
@@ -0,0 +1,42 @@
+#ifndef _queue_hpp_
+#define _queue_hpp_
+
+#include <vector>
+#include <GL/glew.h>
+
+#include "matrix.hpp"
+#include "geometry.hpp"
+
+class program;
+class rendering_context;
+
+// Everything needed to issue one draw call after the graph traversal:
+// the program, its material state at traversal time, the geometry and
+// the matrices.
+struct draw_item {
+    draw_item(program* prog, const geometry<float>& geom, const rendering_context& ctx);
+    program* prog;
+    GLuint tex;
+    color col;
+    const geometry<float>* geom;
+    matrix44 mvp;
+    matrix44 mv;
+    vector3 dir;
+};
+
+// Collects the draw items of a pass and submits them sorted by program,
+// material and geometry, so that state only changes between runs of
+// compatible items. The runs of items sharing the material and the geometry
+// go to the program at once, which may merge them into one draw call. The
+// draws and material changes go to gl_stats.
+class render_queue {
+public:
+    void push(const geometry<float>& geom, rendering_context& ctx);
+    void flush();
+private:
+    std::vector<draw_item> items;
+    std::vector<size_t> order;
+    std::vector<const draw_item*> run;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef _random_hpp_
+#define _random_hpp_
+
+#include <cstdint>
+
+// A small generator (xorshift64*) owned by each maze and each game, so that
+// a seed gives back the same maze and the same game on any thread.
+class rng {
+public:
+    rng(uint64_t seed = 1) { reseed(seed); }
+    // the state must never be zero
+    void reseed(uint64_t seed) { state = (seed + 1) * 0x9E3779B97F4A7C15ull | 1; }
+    uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return (uint32_t)((state * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+    // in [0, n)
+    int below(int n) { return (int)(((uint64_t)next() * (uint64_t)n) >> 32); }
+    uint64_t get_state() const { return state; }
+    void set_state(uint64_t s) { state = s; }
+private:
+    uint64_t state;
+};
+
+#endif
@@ -0,0 +1,206 @@
+// Offscreen render benchmark: drives the menu and play scenes for a number of
+// frames at chosen maze sizes and reports frame times, the GPU time of the
+// passes, draw statistics and uploads.
+//   amazing_render_bench [--frames N] [--warmup N] [--size S]... [--bad-guys N]
+//                        [--scene menu|play|all] [--maze grid|geometry]
+//                        [--width W] [--height H]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+#include "headless.hpp"
+#include "amazing.hpp"
+#include "game.hpp"
+#include "queue.hpp"
+#include "timer.hpp"
+#include "misc.hpp"
+#include "resources.hpp"
+#include "allocations.hpp"
+#include "gl_stats.hpp"
+#include "gpu_timer.hpp"
+
+struct bench_options {
+    int frames;
+    int warmup;
+    std::vector<int> sizes;
+    int bad_guys;
+    std::string scene;
+    maze_renderer maze;
+    int width;
+    int height;
+};
+
+static void report(const std::string& scene, int size, int bad_guys, std::vector<double>& times,
+                   const gpu_timer* gpu, long allocations) {
+    const gl_counts& stats = gl_stats::get().get_totals();
+    std::sort(times.begin(), times.end());
+    double total = 0.0;
+    for (double t : times) total += t;
+    size_t n = times.size();
+    std::cout << std::fixed << std::setprecision(3)
+              << "scene=" << scene << " size=" << size;
+    if (bad_guys >= 0) std::cout << " bad_guys=" << bad_guys;
+    std::cout << " frames=" << n
+              << " mean_ms=" << total / n * 1000.0
+              << " min_ms=" << times[0] * 1000.0
+              << " p50_ms=" << times[n / 2] * 1000.0
+              << " p95_ms=" << times[std::min(n - 1, n * 95 / 100)] * 1000.0
+              << " max_ms=" << times[n - 1] * 1000.0;
+    if (gpu) {
+        for (int p = 0; p < gpu_pass_count; p++) {
+            gpu_pass pass = (gpu_pass) p;
+            if (gpu->get_samples(pass) == 0) continue;
+            std::cout << " " << get_pass_name(pass) << "_gpu_ms=" << gpu->get_mean_seconds(pass) * 1000.0;
+        }
+    }
+    std::cout
+              << std::setprecision(1)
+              << " draws=" << (double) stats.draws / n
+              << " binds=" << (double) stats.material_binds / n
+              << " vertices=" << (double) stats.vertices / n
+              << " uniforms=" << (double) stats.uniforms / n
+              << " uploaded_bytes=" << (double) stats.uploaded_bytes / n
+              << " allocations=" << (double) allocations / n
+              << std::endl;
+}
+
+static void bench_menu(const bench_options& options, int size) {
+    maze_model model(size, size);
+    model.create(size);
+    auto scene = make_maze_scene(model, options.width, options.height);
+    rendering_context ctx;
+    ctx.dir = vector3(0, 0, -1.0f);
+    render_queue queue;
+    ctx.queue = &queue;
+    std::vector<double> times;
+    times.reserve(options.frames);
+    long allocations = 0;
+    std::unique_ptr<gpu_timer> gpu;
+    timer frame_timer;
+    for (int frame = 0; frame < options.warmup + options.frames; frame++) {
+        if (frame == options.warmup) {
+            gl_stats::get().reset();
+            if (gpu_timer::is_supported()) {
+                gpu.reset(new gpu_timer());
+                ctx.gpu = gpu.get();
+            }
+            allocations = thread_allocation_count();
+        }
+        ctx.frame_count = frame;
+        ctx.elapsed_time_seconds = frame / 60.0;
+        frame_timer.reset();
+        render_maze_scene(*scene, ctx, color(0.0f, 1.0f, 0.0f));
+        glFinish();
+        gl_stats::get().end_frame();
+        if (gpu) gpu->end_frame();
+        if (frame >= options.warmup) times.push_back(frame_timer.elapsed());
+    }
+    check_for_opengl_errors();
+    report("menu", size, -1, times, gpu.get(), thread_allocation_count() - allocations);
+}
+
+static void bench_play(const bench_options& options, int size) {
+    maze_model model(size, size);
+    model.create(size);
+    auto game = make_game_data(model, size, options.bad_guys);
+    auto scene = make_game_scene(*game, color(0.0f, 1.0f, 0.0f), options.width, options.height, options.maze);
+    rendering_context ctx;
+    render_queue queue;
+    ctx.queue = &queue;
+    std::vector<double> times;
+    times.reserve(options.frames);
+    long allocations = 0;
+    std::unique_ptr<gpu_timer> gpu;
+    timer frame_timer;
+    for (int frame = 0; frame < options.warmup + options.frames; frame++) {
+        if (frame == options.warmup) {
+            gl_stats::get().reset();
+            if (gpu_timer::is_supported()) {
+                gpu.reset(new gpu_timer());
+                ctx.gpu = gpu.get();
+            }
+            allocations = thread_allocation_count();
+        }
+        game->arena.reset();
+        ctx.frame_count = frame;
+        ctx.elapsed_time_seconds = frame / 60.0;
+        frame_timer.reset();
+        actor_data& hero = *game->heroes_data[0];
+        hero.next_direction = bot_direction(*game, hero, game->random);
+        update_game(*game);
+        render_game(*game, *scene, ctx);
+        glFinish();
+        gl_stats::get().end_frame();
+        if (gpu) gpu->end_frame();
+        if (frame >= options.warmup) times.push_back(frame_timer.elapsed());
+    }
+    check_for_opengl_errors();
+    report(options.maze == maze_renderer::grid ? "play-grid" : "play-geometry", size, (int) game->bad_guys_data.size(), times, gpu.get(), thread_allocation_count() - allocations);
+}
+
+int main(int argc, char* argv[]) {
+    bench_options options;
+    options.frames = 300;
+    options.warmup = 10;
+    options.bad_guys = -1;
+    options.scene = "all";
+    options.maze = maze_renderer::grid;
+    options.width = 800;
+    options.height = 600;
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (i + 1 == argc) {
+            std::cout << "missing value for " << arg << std::endl;
+            return -1;
+        }
+        const char* text = argv[i + 1];
+        int value = 0;
+        bool parsed = true;
+        if (arg == "--frames") {
+            parsed = parse_int(text, value);
+            options.frames = std::max(1, value);
+        }
+        else if (arg == "--warmup") {
+            parsed = parse_int(text, value);
+            options.warmup = std::max(0, value);
+        }
+        else if (arg == "--size") {
+            parsed = parse_int(text, value);
+            options.sizes.push_back(value);
+        }
+        else if (arg == "--bad-guys") parsed = parse_int(text, options.bad_guys);
+        else if (arg == "--scene") options.scene = text;
+        else if (arg == "--maze") options.maze = std::string(text) == "geometry" ? maze_renderer::geometry : maze_renderer::grid;
+        else if (arg == "--width") parsed = parse_int(text, options.width);
+        else if (arg == "--height") parsed = parse_int(text, options.height);
+        else {
+            std::cout << "unknown option " << arg << std::endl;
+            return -1;
+        }
+        if (!parsed) {
+            std::cout << "bad value for " << arg << ": " << text << std::endl;
+            return -1;
+        }
+    }
+    if (options.sizes.empty()) {
+        options.sizes = { 11, 31, 65, 123, 181 };
+    }
+    try {
+        headless_context context(options.width, options.height);
+        std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION)
+                  << ", " << options.width << "x" << options.height << std::endl;
+        for (int size : options.sizes) {
+            if (options.scene == "menu" || options.scene == "all") bench_menu(options, size);
+            if (options.scene == "play" || options.scene == "all") bench_play(options, size);
+        }
+        resource_cache::get().clear();
+    } catch (std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include "resources.hpp"
+#include "assets.hpp"
+
+resource_cache& resource_cache::get() {
+    static resource_cache cache;
+    return cache;
+}
+
+std::shared_ptr<texture> resource_cache::acquire_texture(const std::string& filename) {
+    return acquire<texture>("texture:" + filename, [&filename]() {
+        std::shared_ptr<sf::Image> image = asset_loader::get().image(filename).get();
+        return std::make_shared<texture>((GLubyte*)image->getPixelsPtr(), image->getSize().x, image->getSize().y);
+    });
+}
+
+std::shared_ptr<texture_atlas> resource_cache::acquire_atlas(const std::vector<std::string>& filenames) {
+    std::string name = "atlas:";
+    for (auto& filename : filenames) {
+        name += filename + ";";
+    }
+    return acquire<texture_atlas>(name, [&filenames]() {
+        std::vector<std::shared_ptr<sf::Image>> images;
+        texture_atlas_builder builder;
+        for (auto& filename : filenames) {
+            images.push_back(asset_loader::get().image(filename).get());
+            builder.add(images.back()->getPixelsPtr(), images.back()->getSize().x, images.back()->getSize().y);
+        }
+        return builder.build();
+    });
+}
+
+void resource_cache::clear() {
+    resources.clear();
+}
@@ -0,0 +1,41 @@
+#ifndef _resources_hpp_
+#define _resources_hpp_
+
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+
+#include "texture.hpp"
+
+// Process wide registry of the GL resources (textures, programs, geometries)
+// keyed by asset name. A resource is created on its first request and then
+// shared, so that moving between the menu, play and the ending does no file
+// I/O and no shader compilation. clear() must be called while the GL context
+// is still alive.
+class resource_cache {
+public:
+    static resource_cache& get();
+
+    template <class T, class F>
+    std::shared_ptr<T> acquire(const std::string& name, F create) {
+        auto it = resources.find(name);
+        if (it != resources.end()) {
+            return std::static_pointer_cast<T>(it->second);
+        }
+        std::shared_ptr<T> resource = create();
+        resources[name] = resource;
+        return resource;
+    }
+
+    std::shared_ptr<texture> acquire_texture(const std::string& filename);
+    // one atlas per list of images, the sprite indices follow the list
+    std::shared_ptr<texture_atlas> acquire_atlas(const std::vector<std::string>& filenames);
+    void clear();
+private:
+    resource_cache() {}
+    resource_cache(const resource_cache&);
+    std::map<std::string, std::shared_ptr<void>> resources;
+};
+
+#endif
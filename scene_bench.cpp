@@ -0,0 +1,199 @@
+// Microbenchmarks of the CPU side of rendering: scene graph traversal, the
+// matrix stacks, the camera and the programs' render paths, over the stub GL
+// of gl_stub.cpp so that no context is needed. One JSON object per line:
+//   {"bench": "traversal_queued", "nodes": 1000, "mean_us": ..., "gl_calls": ...}
+//   amazing_scene_bench [--nodes N]... [--min-time SECONDS]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+
+#include "amazing.hpp"
+#include "graph.hpp"
+#include "queue.hpp"
+#include "timer.hpp"
+#include "gl_stub.hpp"
+#include "misc.hpp"
+
+// the leaves are spread over groups of this many, each with its transform
+static const int leaves_per_group = 8;
+
+// Runs f for at least min_time and 3 times, f rendering one frame, and
+// prints the time and the GL calls of a frame.
+template <class F>
+static void measure(const std::string& name, int nodes, double min_time, F f) {
+    f();
+    std::vector<double> times;
+    gl_stub_reset_counts();
+    timer total;
+    while (times.size() < 3 || total.elapsed() < min_time) {
+        timer t;
+        f();
+        times.push_back(t.elapsed());
+    }
+    gl_stub_counts counts = gl_stub_get_counts();
+    std::sort(times.begin(), times.end());
+    double sum = 0.0;
+    for (double t : times) sum += t;
+    size_t n = times.size();
+    std::cout << std::fixed << std::setprecision(3)
+              << "{\"bench\": \"" << name << "\", \"nodes\": " << nodes
+              << ", \"iterations\": " << n
+              << ", \"mean_us\": " << sum / n * 1e6
+              << ", \"min_us\": " << times[0] * 1e6
+              << ", \"p50_us\": " << times[n / 2] * 1e6
+              << ", \"max_us\": " << times[n - 1] * 1e6
+              << std::setprecision(1)
+              << ", \"gl_calls\": " << (double) counts.calls / n
+              << ", \"draws\": " << (double) counts.draws / n
+              << ", \"state\": " << (double) counts.state / n
+              << ", \"uniforms\": " << (double) counts.uniforms / n
+              << "}" << std::endl;
+}
+
+static std::shared_ptr<camera> make_camera() {
+    clipping_volume cv;
+    cv.left = -1.0f;
+    cv.right = 1.0f;
+    cv.bottom = -1.0f;
+    cv.top = 1.0f;
+    cv.nearp = 1.0f;
+    cv.farp = 100.0f;
+    auto cam = std::make_shared<perspective_camera>(cv);
+    cam->move_backward(10.0f);
+    return cam;
+}
+
+// nodes leaves sharing geom, in groups turned a little from one another
+static std::shared_ptr<group> make_graph(int nodes, std::shared_ptr<geometry<float>> geom) {
+    auto root = std::make_shared<group>();
+    std::shared_ptr<group> g;
+    for (int i = 0; i < nodes; i++) {
+        if (i % leaves_per_group == 0) {
+            g = std::make_shared<group>();
+            g->transformation(multm(rotation(i * 0.1f, 0.0f, 0.0f, 1.0f), translation(i * 0.01f, 0.0f, 0.0f)));
+            root->add(g);
+        }
+        g->add(std::make_shared<geometry_node<float>>(geom));
+    }
+    return root;
+}
+
+static void bench_nodes(int nodes, double min_time) {
+    maze_model model(11, 11);
+    model.create(11);
+    maze_geometry_builder_2d builder_2d(model);
+    auto geom_2d = builder_2d.build();
+    maze_geometry_builder_3d builder_3d(model);
+    auto geom_3d = builder_3d.build();
+    actor_builder_2d actor_builder;
+    auto geom_actor = actor_builder.build();
+
+    auto monochrome_pr = monochrome_program::create();
+    monochrome_pr->set_color(color(0.0f, 1.0f, 0.0f));
+    auto cam = make_camera();
+    auto root = make_graph(nodes, geom_2d);
+    auto compiled = std::make_shared<compiled_group>(root);
+    rendering_context ctx;
+    ctx.dir = vector3(0, 0, -1.0f);
+    render_queue queue;
+
+    measure("traversal_direct", nodes, min_time, [&]() {
+        ctx.queue = nullptr;
+        cam->render(root, ctx, monochrome_pr);
+    });
+    measure("traversal_queued", nodes, min_time, [&]() {
+        ctx.queue = &queue;
+        cam->render(root, ctx, monochrome_pr);
+        queue.flush();
+    });
+    measure("compiled_queued", nodes, min_time, [&]() {
+        ctx.queue = &queue;
+        cam->render(compiled, ctx, monochrome_pr);
+        queue.flush();
+    });
+    ctx.queue = nullptr;
+
+    matrix44 m = rotation(10.0f, 0.0f, 1.0f, 0.0f);
+    measure("context_push_pop", nodes, min_time, [&]() {
+        for (int i = 0; i < nodes; i++) {
+            ctx.push(m);
+            ctx.pop();
+        }
+    });
+    measure("position_and_orient", nodes, min_time, [&]() {
+        for (int i = 0; i < nodes; i++) {
+            cam->rotate_y(0.1f);
+            cam->position_and_orient();
+        }
+    });
+
+    // a program's render path, nodes draws of the geometry it is made for
+    GLubyte pixels[4 * 4] = { 0 };
+    auto tex = std::make_shared<texture>(pixels, 2, 2);
+    auto flat_shading_pr = flat_shading_program::Create();
+    auto texture_pr = texture_program::create();
+    texture_pr->set_texture(tex);
+    auto sprite_pr = sprite_program::create();
+    sprite_pr->set_texture(tex);
+    struct path {
+        const char* name;
+        std::shared_ptr<program> prog;
+        std::shared_ptr<geometry<float>> geom;
+    };
+    path paths[] = {
+        { "render_monochrome", monochrome_pr, geom_2d },
+        { "render_flat_shading", flat_shading_pr, geom_3d },
+        { "render_texture", texture_pr, geom_actor },
+        { "render_sprite", sprite_pr, geom_actor },
+    };
+    // as cameras set the context up
+    ctx.projection(frustum(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 100.0f));
+    ctx.push(cam->position_and_orient());
+    for (auto& p : paths) {
+        ctx.prog = p.prog;
+        measure(p.name, nodes, min_time, [&]() {
+            for (int i = 0; i < nodes; i++) {
+                p.prog->render(*p.geom, ctx);
+            }
+        });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> node_counts;
+    double min_time = 0.2;
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (i + 1 == argc) {
+            std::cout << "missing value for " << arg << std::endl;
+            return -1;
+        }
+        const char* text = argv[i + 1];
+        int nodes = 0;
+        bool parsed;
+        if (arg == "--nodes") {
+            parsed = parse_int(text, nodes);
+            node_counts.push_back(std::max(1, nodes));
+        }
+        else if (arg == "--min-time") parsed = parse_double(text, min_time);
+        else {
+            std::cout << "unknown option " << arg << std::endl;
+            return -1;
+        }
+        if (!parsed) {
+            std::cout << "bad value for " << arg << ": " << text << std::endl;
+            return -1;
+        }
+    }
+    if (node_counts.empty()) {
+        node_counts = { 1000, 4000, 16000 };
+    }
+    for (int nodes : node_counts) {
+        bench_nodes(nodes, min_time);
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+#include "snapshot.hpp"
+
+static const char magic[8] = { 'A', 'M', 'Z', 'S', 'N', 'A', 'P', '1' };
+// the bytes of an actor, as write_actor writes them
+static const size_t actor_size = 23;
+// larger mazes would not fit in memory anyway
+static const uint32_t max_side = 1 << 14;
+
+class snapshot_writer {
+public:
+    snapshot_writer(std::vector<char>& out) : out(out) {}
+    template <class T>
+    snapshot_writer& operator<<(const T& value) {
+        const char* p = (const char*) &value;
+        out.insert(out.end(), p, p + sizeof(T));
+        return *this;
+    }
+private:
+    std::vector<char>& out;
+};
+
+class snapshot_reader {
+public:
+    snapshot_reader(const std::vector<char>& in) : in(in), offset(0) {}
+    template <class T>
+    snapshot_reader& operator>>(T& value) {
+        need(sizeof(T));
+        memcpy(&value, &in[offset], sizeof(T));
+        offset += sizeof(T);
+        return *this;
+    }
+    const unsigned char* bytes(size_t size) {
+        need(size);
+        const unsigned char* p = (const unsigned char*) &in[offset];
+        offset += size;
+        return p;
+    }
+    size_t remaining() const {
+        return in.size() - offset;
+    }
+private:
+    void need(size_t size) {
+        if (offset + size > in.size()) throw std::runtime_error("snapshot: truncated");
+    }
+    const std::vector<char>& in;
+    size_t offset;
+};
+
+static void write_actor(snapshot_writer& w, const actor_data& ad) {
+    w << (int32_t) ad.pos_x << (int32_t) ad.pos_y << ad.pos_fx << ad.pos_fy
+      << (uint8_t) ad.dir << (uint8_t) ad.next_direction << ad.inc << (uint8_t) ad.nature;
+}
+
+static void read_actor(snapshot_reader& r, actor_data& ad) {
+    int32_t x, y;
+    uint8_t dir, next_direction, nature;
+    r >> x >> y >> ad.pos_fx >> ad.pos_fy >> dir >> next_direction >> ad.inc >> nature;
+    ad.pos_x = x;
+    ad.pos_y = y;
+    ad.dir = (direction) dir;
+    ad.next_direction = (direction) next_direction;
+    ad.nature = (actor_nature) nature;
+}
+
+// the actors must stand in the maze and move at the step of their nature,
+// a corrupt file is rejected before it
+// can change the game
+static std::vector<actor_data> read_actors(snapshot_reader& r, int width, int height) {
+    uint32_t count;
+    r >> count;
+    if (count > r.remaining() / actor_size) throw std::runtime_error("snapshot: truncated");
+    std::vector<actor_data> actors(count);
+    for (auto& ad : actors) {
+        read_actor(r, ad);
+        bool inside = ad.pos_x >= 0 && ad.pos_x < width && ad.pos_y >= 0 && ad.pos_y < height &&
+                      ad.pos_fx >= 0.0f && ad.pos_fx <= width - 1 && ad.pos_fy >= 0.0f && ad.pos_fy <= height - 1;
+        bool valid = (int) ad.dir <= (int) direction::left && (int) ad.next_direction <= (int) direction::left &&
+                     (int) ad.nature <= (int) actor_nature::evil &&
+                     ad.inc == (ad.nature == actor_nature::good ? hero_inc : bad_guy_inc);
+        if (!inside) throw std::runtime_error("snapshot: an actor is outside of the maze");
+        if (!valid) throw std::runtime_error("snapshot: an actor has an unknown state");
+    }
+    return actors;
+}
+
+// as many actors as in the snapshot, reusing the ones already there
+static void set_actors(std::vector<std::shared_ptr<actor_data>>& actors, const std::vector<actor_data>& saved) {
+    actors.resize(saved.size());
+    for (size_t i = 0; i < saved.size(); i++) {
+        if (actors[i]) {
+            *actors[i] = saved[i];
+        } else {
+            actors[i] = std::make_shared<actor_data>(saved[i]);
+        }
+    }
+}
+
+std::vector<char> save_snapshot(game_data& game) {
+    maze_model& model = game.model;
+    int width = model.get_width();
+    int height = model.get_height();
+    std::vector<char> out(magic, magic + sizeof(magic));
+    out.reserve(sizeof(magic) + 64 + (game.heroes_data.size() + game.bad_guys_data.size()) * 32 + (width * height + 7) / 8);
+    snapshot_writer w(out);
+    w << (uint32_t) width << (uint32_t) height << (int64_t) game.tick << game.random.get_state();
+    w << (uint32_t) game.heroes_data.size();
+    for (auto& hero_data : game.heroes_data) {
+        write_actor(w, *hero_data);
+    }
+    w << (uint32_t) game.bad_guys_data.size();
+    for (auto& bad_guy_data : game.bad_guys_data) {
+        write_actor(w, *bad_guy_data);
+    }
+    std::vector<cell>& cells = model.get_cells();
+    for (size_t i = 0; i < cells.size(); i += 8) {
+        uint8_t bits = 0;
+        for (size_t b = 0; b < 8 && i + b < cells.size(); b++) {
+            if (cells[i + b].wall) bits |= 1 << b;
+        }
+        w << bits;
+    }
+    return out;
+}
+
+static void read_header(snapshot_reader& r, int& width, int& height) {
+    const unsigned char* m = r.bytes(sizeof(magic));
+    if (memcmp(m, magic, sizeof(magic)) != 0) throw std::runtime_error("snapshot: not a snapshot");
+    uint32_t w, h;
+    r >> w >> h;
+    if (w < 3 || h < 3 || w > max_side || h > max_side) throw std::runtime_error("snapshot: bad maze size");
+    width = w;
+    height = h;
+}
+
+void get_snapshot_size(const std::vector<char>& snapshot, int& width, int& height) {
+    snapshot_reader r(snapshot);
+    read_header(r, width, height);
+}
+
+void restore_snapshot(const std::vector<char>& snapshot, game_data& game, game_scene* scene) {
+    snapshot_reader r(snapshot);
+    int width, height;
+    read_header(r, width, height);
+    maze_model& model = game.model;
+    if (width != model.get_width() || height != model.get_height()) {
+        throw std::runtime_error("snapshot: the maze has another size");
+    }
+    int64_t tick;
+    uint64_t state;
+    r >> tick >> state;
+    std::vector<actor_data> heroes = read_actors(r, width, height);
+    if (heroes.empty()) throw std::runtime_error("snapshot: no hero");
+    std::vector<actor_data> bad_guys = read_actors(r, width, height);
+    std::vector<cell>& cells = model.get_cells();
+    size_t wall_bytes = (cells.size() + 7) / 8;
+    if (r.remaining() != wall_bytes) throw std::runtime_error("snapshot: the walls do not match the maze size");
+    const unsigned char* bits = r.bytes(wall_bytes);
+    // the whole snapshot was read, nothing can fail from here
+    set_actors(game.heroes_data, heroes);
+    set_actors(game.bad_guys_data, bad_guys);
+    // the walls all go to the model, then the scene uploads its maze once
+    bool changed = false;
+    for (size_t i = 0; i < cells.size(); i++) {
+        bool wall = (bits[i / 8] >> (i % 8)) & 1;
+        if (cells[i].wall == wall) continue;
+        cells[i].wall = wall;
+        changed = true;
+    }
+    if (scene && changed) walls_changed(*scene);
+    game.tick = (long) tick;
+    game.random.set_state(state);
+}
+
+void write_snapshot_file(const std::string& path, const std::vector<char>& snapshot) {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    out.write(snapshot.data(), snapshot.size());
+    if (!out) throw std::runtime_error("snapshot: cannot write " + path);
+}
+
+std::vector<char> read_snapshot_file(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) throw std::runtime_error("snapshot: cannot read " + path);
+    return std::vector<char>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
@@ -0,0 +1,26 @@
+#ifndef _snapshot_hpp_
+#define _snapshot_hpp_
+
+#include <vector>
+#include <string>
+
+#include "game.hpp"
+
+// The complete state of a running game in a compact binary form, in the
+// byte order of the machine: the walls a bit per cell, the actors, the
+// generator and the tick.
+
+std::vector<char> save_snapshot(game_data& game);
+
+// the size of the maze of a snapshot, to make the model to restore it into
+void get_snapshot_size(const std::vector<char>& snapshot, int& width, int& height);
+
+// Restores into a game whose maze has the snapshot's size. Only the cells
+// that differ are written, in the model and in the scene's maze when there
+// is one, so that the maze is neither created nor rebuilt.
+void restore_snapshot(const std::vector<char>& snapshot, game_data& game, game_scene* scene = nullptr);
+
+void write_snapshot_file(const std::string& path, const std::vector<char>& snapshot);
+std::vector<char> read_snapshot_file(const std::string& path);
+
+#endif
@@ -0,0 +1,17 @@
+#version 330 core
+
+uniform mat4 mvpMatrix;
+uniform vec4 sprites[8];
+
+in vec2 pos;
+in vec2 texCoord;
+in vec3 instance;
+
+out vec2 vTexCoord;
+
+void main(void)
+{
+    gl_Position = mvpMatrix * vec4(pos + instance.xy, 0.0f, 1.0f);
+    vec4 sprite = sprites[int(instance.z)];
+    vTexCoord = sprite.xy + texCoord * sprite.zw;
+}
@@ -0,0 +1,124 @@
+#include "state.hpp"
+#include "gl_stats.hpp"
+
+gl_state& gl_state::get() {
+    static gl_state state;
+    return state;
+}
+
+gl_state::gl_state() : generation(0) {
+    invalidate();
+}
+
+void gl_state::use_program(GLuint id) {
+    if (program == id) return;
+    glUseProgram(id);
+    program = id;
+    gl_stats::get().program_bind();
+}
+
+void gl_state::bind_texture(GLenum unit, GLuint id) {
+    int index = unit - GL_TEXTURE0;
+    if (index < max_texture_units && textures[index] == id) return;
+    if (active_unit != unit) {
+        glActiveTexture(unit);
+        active_unit = unit;
+    }
+    glBindTexture(GL_TEXTURE_2D, id);
+    gl_stats::get().texture_bind();
+    if (index < max_texture_units) textures[index] = id;
+}
+
+void gl_state::bind_buffer(GLenum target, GLuint id) {
+    auto it = buffers.find(target);
+    if (it != buffers.end() && it->second == id) return;
+    glBindBuffer(target, id);
+    buffers[target] = id;
+    gl_stats::get().buffer_bind();
+}
+
+void gl_state::bind_vertex_array(GLuint id) {
+    if (vertex_array == id) return;
+    glBindVertexArray(id);
+    vertex_array = id;
+    gl_stats::get().vertex_array_bind();
+}
+
+void gl_state::enable(GLenum cap) {
+    auto it = capabilities.find(cap);
+    if (it != capabilities.end() && it->second) return;
+    glEnable(cap);
+    capabilities[cap] = true;
+}
+
+void gl_state::disable(GLenum cap) {
+    auto it = capabilities.find(cap);
+    if (it != capabilities.end() && !it->second) return;
+    glDisable(cap);
+    capabilities[cap] = false;
+}
+
+void gl_state::blend_func(GLenum src, GLenum dst) {
+    if (blend_src == src && blend_dst == dst) return;
+    glBlendFunc(src, dst);
+    blend_src = src;
+    blend_dst = dst;
+}
+
+void gl_state::uniform(GLint location, GLint v) {
+    glUniform1i(location, v);
+    gl_stats::get().uniform();
+}
+
+void gl_state::uniform(GLint location, GLfloat x, GLfloat y, GLfloat z) {
+    glUniform3f(location, x, y, z);
+    gl_stats::get().uniform();
+}
+
+void gl_state::uniform(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+    glUniform4f(location, x, y, z, w);
+    gl_stats::get().uniform();
+}
+
+void gl_state::uniform_4fv(GLint location, GLsizei count, const GLfloat* v) {
+    glUniform4fv(location, count, v);
+    gl_stats::get().uniform();
+}
+
+void gl_state::uniform_matrix(GLint location, const GLfloat* m) {
+    uniform_matrix(location, 1, m);
+}
+
+void gl_state::uniform_matrix(GLint location, GLsizei count, const GLfloat* m) {
+    glUniformMatrix4fv(location, count, GL_FALSE, m);
+    gl_stats::get().uniform();
+}
+
+void gl_state::invalidate() {
+    program = unknown;
+    vertex_array = unknown;
+    active_unit = unknown;
+    for (int i = 0; i < max_texture_units; i++) {
+        textures[i] = unknown;
+    }
+    blend_src = unknown;
+    blend_dst = unknown;
+    buffers.clear();
+    capabilities.clear();
+}
+
+void gl_state::release() {
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    invalidate();
+}
+
+void gl_state::context_changed() {
+    generation++;
+    invalidate();
+}
+
+unsigned gl_state::get_generation() const {
+    return generation;
+}
@@ -0,0 +1,49 @@
+#ifndef _state_hpp_
+#define _state_hpp_
+
+#include <map>
+#include <GL/glew.h>
+
+// Shadow copy of the GL state touched by the renderer, used to skip
+// redundant binds and enables. Code changing the GL state behind its back
+// (SFML drawing) must call release() or invalidate(), and a re-created
+// window must call context_changed() since vertex arrays are not shared
+// between contexts.
+class gl_state {
+public:
+    static gl_state& get();
+    void use_program(GLuint id);
+    void bind_texture(GLenum unit, GLuint id);
+    void bind_buffer(GLenum target, GLuint id);
+    void bind_vertex_array(GLuint id);
+    void enable(GLenum cap);
+    void disable(GLenum cap);
+    void blend_func(GLenum src, GLenum dst);
+    // the uniforms of the program in use, always set, counted in gl_stats
+    void uniform(GLint location, GLint v);
+    void uniform(GLint location, GLfloat x, GLfloat y, GLfloat z);
+    void uniform(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+    void uniform_4fv(GLint location, GLsizei count, const GLfloat* v);
+    void uniform_matrix(GLint location, const GLfloat* m);
+    void uniform_matrix(GLint location, GLsizei count, const GLfloat* m);
+    void invalidate();
+    void release();
+    void context_changed();
+    unsigned get_generation() const;
+private:
+    gl_state();
+    gl_state(const gl_state&);
+    static const GLuint unknown = ~0u;
+    static const int max_texture_units = 8;
+    unsigned generation;
+    GLuint program;
+    GLuint vertex_array;
+    GLenum active_unit;
+    GLuint textures[max_texture_units];
+    GLenum blend_src;
+    GLenum blend_dst;
+    std::map<GLenum, GLuint> buffers;
+    std::map<GLenum, bool> capabilities;
+};
+
+#endif
@@ -1,19 +1,136 @@
-#include "texture.hpp"
-
-texture::texture(GLubyte* data, GLsizei w, GLsizei h) {
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-}
-
-texture::~texture() {
-    glDeleteTextures(1, &id);
-}
-
-GLuint texture::get_id() const {
-    return id;
-}
+#include <algorithm>
+
+#include "texture.hpp"
+#include "state.hpp"
+#include "gl_stats.hpp"
+
+texture::texture(GLubyte* data, GLsizei w, GLsizei h, bool mipmaps) {
+    glGenTextures(1, &id);
+    gl_state::get().bind_texture(GL_TEXTURE0, id);
+    GLint wrap = mipmaps ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    gl_stats::get().upload((long) w * h * 4);
+    if (mipmaps) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+texture::~texture() {
+    glDeleteTextures(1, &id);
+    gl_state::get().invalidate();
+}
+
+GLuint texture::get_id() const {
+    return id;
+}
+
+void texture::set_max_level(GLint level) {
+    gl_state::get().bind_texture(GL_TEXTURE0, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level);
+}
+
+grid_texture::grid_texture(const GLubyte* data, GLsizei w, GLsizei h) {
+    glGenTextures(1, &id);
+    gl_state::get().bind_texture(GL_TEXTURE0, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    // the rows are not padded to four bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, data);
+    gl_stats::get().upload((long) w * h);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+grid_texture::~grid_texture() {
+    glDeleteTextures(1, &id);
+    gl_state::get().invalidate();
+}
+
+void grid_texture::update(GLint x, GLint y, GLsizei w, GLsizei h, const GLubyte* data) {
+    gl_state::get().bind_texture(GL_TEXTURE0, id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, GL_RED, GL_UNSIGNED_BYTE, data);
+    gl_stats::get().upload((long) w * h);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+texture_atlas::texture_atlas(std::shared_ptr<texture> tex, const std::vector<atlas_rect>& rects) :
+    tex(tex), rects(rects) {}
+
+texture_atlas_builder::texture_atlas_builder(int padding) : padding(padding) {}
+
+int texture_atlas_builder::add(const GLubyte* data, GLsizei w, GLsizei h) {
+    image img = {data, w, h};
+    images.push_back(img);
+    return (int) images.size() - 1;
+}
+
+static GLsizei next_power_of_two(GLsizei n) {
+    GLsizei p = 1;
+    while (p < n) p *= 2;
+    return p;
+}
+
+// shelf placement for a given atlas width, returns the height used
+GLsizei texture_atlas_builder::place(GLsizei width, std::vector<GLsizei>& xs, std::vector<GLsizei>& ys) const {
+    xs.clear();
+    ys.clear();
+    GLsizei x = 0, y = 0, shelf = 0;
+    for (auto& img : images) {
+        if (x > 0 && x + img.w > width) {
+            x = 0;
+            y += shelf + padding;
+            shelf = 0;
+        }
+        xs.push_back(x);
+        ys.push_back(y);
+        x += img.w + padding;
+        shelf = std::max(shelf, img.h);
+    }
+    return y + shelf;
+}
+
+std::shared_ptr<texture_atlas> texture_atlas_builder::build() {
+    GLsizei widest = 1, total = 0;
+    for (auto& img : images) {
+        widest = std::max(widest, img.w);
+        total += img.w + padding;
+    }
+    std::vector<GLsizei> xs, ys;
+    GLsizei width = 0, height = 0;
+    for (GLsizei w = next_power_of_two(widest); w <= next_power_of_two(total); w *= 2) {
+        GLsizei h = next_power_of_two(place(w, xs, ys));
+        if (width == 0 || (long) w * h < (long) width * height ||
+            ((long) w * h == (long) width * height && std::max(w, h) < std::max(width, height))) {
+            width = w;
+            height = h;
+        }
+    }
+    place(width, xs, ys);
+
+    std::vector<GLubyte> pixels(width * height * 4, 0);
+    std::vector<atlas_rect> rects;
+    for (size_t i = 0; i < images.size(); i++) {
+        const image& img = images[i];
+        for (GLsizei row = 0; row < img.h; row++) {
+            std::copy(img.data + row * img.w * 4, img.data + (row + 1) * img.w * 4,
+                      pixels.begin() + ((ys[i] + row) * width + xs[i]) * 4);
+        }
+        atlas_rect r = {(float) xs[i] / width, (float) ys[i] / height,
+                        (float) img.w / width, (float) img.h / height};
+        rects.push_back(r);
+    }
+    auto tex = std::make_shared<texture>(pixels.data(), width, height, true);
+    // a texel of level l covers 2^l texels at any alignment, the padding
+    // must hold a whole transparent one: 2^(l+1) - 1 texels
+    GLint level = 0;
+    while ((2 << (level + 1)) - 1 <= padding) level++;
+    tex->set_max_level(level);
+    return std::make_shared<texture_atlas>(tex, rects);
+}
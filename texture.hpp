@@ -1,15 +1,76 @@
-#ifndef _texture_hpp_
-#define _texture_hpp_
-
-#include <GL/glew.h>
-
-class texture {
-public:
-    texture(GLubyte* data, GLsizei w, GLsizei h);
-    ~texture();
-    GLuint get_id() const;
-private:
-    GLuint id;
-};
-
-#endif
\ No newline at end of file
+#ifndef _texture_hpp_
+#define _texture_hpp_
+
+#include <vector>
+#include <memory>
+#include <GL/glew.h>
+
+class texture {
+public:
+    // mipmapped textures are meant for atlases and clamp at the edges,
+    // the others repeat so they can be tiled
+    texture(GLubyte* data, GLsizei w, GLsizei h, bool mipmaps = false);
+    ~texture();
+    GLuint get_id() const;
+    // the smallest mipmap level sampled, GL_TEXTURE_MAX_LEVEL
+    void set_max_level(GLint level);
+private:
+    GLuint id;
+};
+
+// Single channel texture of bytes, one texel per cell of a grid, meant to be
+// read with texelFetch.
+class grid_texture {
+public:
+    grid_texture(const GLubyte* data, GLsizei w, GLsizei h);
+    ~grid_texture();
+    // replaces the texels of a w x h block at (x, y)
+    void update(GLint x, GLint y, GLsizei w, GLsizei h, const GLubyte* data);
+    GLuint get_id() const { return id; }
+private:
+    GLuint id;
+};
+
+// area of a sprite in an atlas, in texture coordinates
+struct atlas_rect {
+    float u;
+    float v;
+    float width;
+    float height;
+};
+
+// Several sprites sharing one mipmapped texture.
+class texture_atlas {
+public:
+    texture_atlas(std::shared_ptr<texture> tex, const std::vector<atlas_rect>& rects);
+    std::shared_ptr<texture> get_texture() const { return tex; }
+    const atlas_rect& get_rect(int sprite) const { return rects[sprite]; }
+    int get_sprite_count() const { return (int) rects.size(); }
+private:
+    std::shared_ptr<texture> tex;
+    std::vector<atlas_rect> rects;
+};
+
+// Packs RGBA images on shelves, in the order they are added, into the
+// smallest power of two texture that holds them. Sprites are separated by
+// transparent padding, and only the mipmap levels whose texels fit in it
+// are sampled, so that the sprites do not bleed into each other: levels 0
+// and 1 with the default padding.
+class texture_atlas_builder {
+public:
+    texture_atlas_builder(int padding = 4);
+    // returns the sprite index
+    int add(const GLubyte* data, GLsizei w, GLsizei h);
+    std::shared_ptr<texture_atlas> build();
+private:
+    struct image {
+        const GLubyte* data;
+        GLsizei w;
+        GLsizei h;
+    };
+    GLsizei place(GLsizei width, std::vector<GLsizei>& xs, std::vector<GLsizei>& ys) const;
+    int padding;
+    std::vector<image> images;
+};
+
+#endif